@@ -0,0 +1,7 @@
+a: int = 0
+n: int = 3000000
+s: int = 0
+while a < n:
+    s += a % 7
+    a += 1
+print(s)
@@ -0,0 +1,12 @@
+def total(n: int, k: int) -> int:
+    if n == 0:
+        return k
+    else:
+        return n + total(n - 1, k)
+
+i: int = 0
+t: int = 0
+while i < 400:
+    t += total(900, i)
+    i += 1
+print(t)
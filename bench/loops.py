@@ -0,0 +1,14 @@
+n: int = 1000000
+k: int = 7
+s: int = 0
+i: int = 0
+while i < n:
+    s += i * 3 + i * 3 + k * k
+    s -= i * 3
+    i += 1
+j: int = 0
+repeat:
+    s -= (j + k) * 2
+    j += 1
+until j >= n
+print(s)
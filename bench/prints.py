@@ -0,0 +1,4 @@
+i: int = 0
+while i < 300000:
+    print(i, "x", True)
+    i += 1
@@ -0,0 +1,6 @@
+t: int = 0
+w: str = "x"
+while t < 300000:
+    w = input("")
+    t += 1
+print(t, w)
@@ -0,0 +1,55 @@
+#!/bin/bash
+#
+# bench/run.sh [dwislpy]
+#
+# Runs each benchmark program bench/*.py with the given interpreter (by
+# default, the one built by `make bench`) and reports the median of its
+# wall-clock times over $RUNS runs (by default, 5), in seconds. Its
+# output goes to /dev/null. A program reads the file of its name with
+# ".in" added, here or in bench/build, if there is one.
+#
+# Each program is run once in each mode listed in $MODES, where the
+# flags of a mode are joined by commas (by default, the interpreter at
+# -O0, then the bytecode machine at -O2, i.e. "-O0 --vm,-O2").
+#
+# Two of the programs are made here, in bench/build: big.py, a long
+# straight-line script that mostly costs parsing and checking, and the
+# input of reads.py.
+#
+cd "$(dirname "$0")"
+BIN=${1:-build/dwislpy}
+RUNS=${RUNS:-5}
+MODES=${MODES:-"-O0 --vm,-O2"}
+mkdir -p build
+
+if [ ! -f build/big.py ]; then
+    {
+        echo "x: int = 0"
+        for ((i = 0; i < 20000; i++)); do
+            echo "x = x + $i * 2 - x // 3"
+        done
+        echo "print(x)"
+    } > build/big.py
+fi
+if [ ! -f build/reads.in ]; then
+    for ((i = 0; i < 300000; i++)); do
+        echo "line $i"
+    done > build/reads.in
+fi
+
+TIMEFORMAT=%R
+printf "%-12s %-16s %s\n" program mode seconds
+for f in *.py build/big.py; do
+    in=/dev/null
+    [ -f "build/${f%.py}.in" ] && in=build/${f%.py}.in
+    [ -f "${f%.py}.in" ] && in=${f%.py}.in
+    for mode in $MODES; do
+        flags=${mode//,/ }
+        times=()
+        for ((r = 0; r < RUNS; r++)); do
+            times+=($( { time "$BIN" --no-cache $flags "$f" > /dev/null 2>&1 < "$in"; } 2>&1 ))
+        done
+        median=$(printf "%s\n" "${times[@]}" | sort -n | sed -n "$(( (RUNS + 1) / 2 ))p")
+        printf "%-12s %-16s %s\n" "$(basename "$f" .py)" "$flags" "$median"
+    done
+done
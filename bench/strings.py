@@ -0,0 +1,7 @@
+s: str = ""
+i: int = 0
+while i < 200000:
+    s += "ab" + "cd" + "ef"
+    i = i + 1
+t: str = "xyz" * 100000
+print(i)
@@ -10,10 +10,15 @@
 #include <exception>
 #include <algorithm>
 #include <sstream>
+#include <cstddef>
+#include <typeinfo>
 
 #include "dwislpy-ast.hh"
 #include "dwislpy-check.hh"
 #include "dwislpy-util.hh"
+#include "dwislpy-vm.hh"
+#include "dwislpy-prof.hh"
+#include "dwislpy-stats.hh"
 
 const std::string DEFAULT_INDENT_STR = "    ";
 
@@ -36,11 +41,11 @@ const std::string DEFAULT_INDENT_STR = "    ";
 // Helper function that converts a DwiSlpy value into a string.
 // This is meant to be used by `print` and also `str`.
 // 
-std::string to_string(Valu v) {
-    if (std::holds_alternative<int>(v)) {
-        return std::to_string(std::get<int>(v));
-    } else if (std::holds_alternative<std::string>(v)) {
-        return std::get<std::string>(v);
+std::string to_string(const Valu& v) {
+    if (std::holds_alternative<Word>(v)) {
+        return std::to_string(std::get<Word>(v));
+    } else if (std::holds_alternative<Strg>(v)) {
+        return std::get<Strg>(v).str();
     } else if (std::holds_alternative<bool>(v)) {
         if (std::get<bool>(v)) {
             return "True";
@@ -49,6 +54,8 @@ std::string to_string(Valu v) {
         }
     } else if (std::holds_alternative<none>(v)) {
         return "None";
+    } else if (std::holds_alternative<Bign>(v)) {
+        return std::get<Bign>(v).str();
     } else {
         return "<unknown>";
     }
@@ -62,13 +69,13 @@ std::string to_string(Valu v) {
 // the source code string for the value. Used by routines that dump
 // a literal value.
 //
-std::string to_repr(Valu v) {
-    if (std::holds_alternative<std::string>(v)) {
+std::string to_repr(const Valu& v) {
+    if (std::holds_alternative<Strg>(v)) {
         //
         // Strings have to be converted to show their quotes and also
         // to have the unprintable chatacters given as \escape sequences.
         //
-        return "\"" + re_escape(std::get<std::string>(v)) + "\"";
+        return "\"" + re_escape(std::get<Strg>(v).str()) + "\"";
     } else {
         //
         // The other types aren't special. (This will have to change when
@@ -78,7 +85,294 @@ std::string to_repr(Valu v) {
     }
 }
 
+//
+// to_stream
+//
+// Outputs a DwiSlpy value just as `print` shows it, i.e. the same
+// characters as `to_string`, but without building a string for it.
+//
+void to_stream(std::ostream& os, const Valu& v) {
+    if (const Strg* s = std::get_if<Strg>(&v)) {
+        os << *s;
+    } else if (const Word* n = std::get_if<Word>(&v)) {
+        os << *n;
+    } else {
+        os << to_string(v);
+    }
+}
+
+//
+// to_sink
+//
+// Outputs a DwiSlpy value as `print` shows it, into the program's
+// buffered output.
+//
+void to_sink(Sink& out, const Valu& v) {
+    if (const Strg* s = std::get_if<Strg>(&v)) {
+        out.put(*s);
+    } else if (const Word* n = std::get_if<Word>(&v)) {
+        out.put(*n);
+    } else if (const bool* b = std::get_if<bool>(&v)) {
+        out.put(*b ? "True" : "False");
+    } else if (const Bign* b = std::get_if<Bign>(&v)) {
+        out.put(b->str());
+    } else {
+        out.put("None");
+    }
+}
+
+//
+// wide_add, wide_sub, wide_mul, wide_div, wide_mod, wide_neg, wide_cmp
+//
+// - int arithmetic whose operands or result need not fit in a `Word`.
+//   Each result is given back as a `Word` if it does fit.
+//
 
+static Bign bign(const Valu& v) {
+    if (const Word* n = std::get_if<Word>(&v)) {
+        return Bign {*n};
+    }
+    return std::get<Bign>(v);
+}
+
+static Valu narrowest(Bign b) {
+    Word n = 0;
+    if (b.fits(n) && n != WIDE) {
+        return Valu {n};
+    }
+    return Valu {std::move(b)};
+}
+
+Valu wide_add(const Valu& v1, const Valu& v2) {
+    return narrowest(bign(v1) + bign(v2));
+}
+
+Valu wide_sub(const Valu& v1, const Valu& v2) {
+    return narrowest(bign(v1) - bign(v2));
+}
+
+Valu wide_mul(const Valu& v1, const Valu& v2) {
+    return narrowest(bign(v1) * bign(v2));
+}
+
+Valu wide_div(const Valu& v1, const Valu& v2) {
+    Bign q {};
+    Bign r {};
+    divmod(bign(v1), bign(v2), q, r);
+    return narrowest(std::move(q));
+}
+
+Valu wide_mod(const Valu& v1, const Valu& v2) {
+    Bign q {};
+    Bign r {};
+    divmod(bign(v1), bign(v2), q, r);
+    return narrowest(std::move(r));
+}
+
+Valu wide_neg(const Valu& v) {
+    return narrowest(-bign(v));
+}
+
+int wide_cmp(const Valu& v1, const Valu& v2) {
+    return compare(bign(v1), bign(v2));
+}
+
+//
+// parse_int(s,v)
+//
+// Reads an int as Python's `int(s)` does: decimal digits, perhaps signed,
+// perhaps with spaces around them. Up to eighteen digits always fit in
+// a `Word`, and are read directly.
+//
+bool parse_int(std::string_view s, Valu& v) {
+    std::size_t first = s.find_first_not_of(" \t\n\r\f\v");
+    if (first == std::string_view::npos) {
+        return false;
+    }
+    std::size_t last = s.find_last_not_of(" \t\n\r\f\v");
+    s = s.substr(first, last + 1 - first);
+    bool negative = s[0] == '-';
+    if (s[0] == '-' || s[0] == '+') {
+        s.remove_prefix(1);
+    }
+    if (s.empty() || s.find_first_not_of("0123456789") != std::string_view::npos) {
+        return false;
+    }
+    if (s.size() <= 18) {
+        Word n = 0;
+        for (char c : s) {
+            n = n * 10 + (c - '0');
+        }
+        v = Valu {negative ? -n : n};
+    } else {
+        v = narrowest(Bign::parse(s, negative));
+    }
+    return true;
+}
+
+Strg repeat(const Strg& s, const Valu& v, Locn lo) {
+    if (s.size() == 0) {
+        return Strg {};
+    } else if (const Word* n = std::get_if<Word>(&v)) {
+        if (*n > 0 && static_cast<unsigned long long>(*n) > std::string {}.max_size() / s.size()) {
+            throw DwislpyError { lo, "Run-time error: repeat count too large." };
+        }
+        return repeat(s, *n);
+    } else if (std::get<Bign>(v).negative()) {
+        return Strg {};
+    } else {
+        throw DwislpyError { lo, "Run-time error: repeat count too large." };
+    }
+}
+
+//
+// narrow(v,ctxt), widen(n,ctxt)
+//
+// Go between an int value and what `eval_int` gives for it.
+//
+static Word narrow(const Valu& v, const Ctxt& ctxt) {
+    if (const Word* n = std::get_if<Word>(&v)) {
+        return *n;
+    }
+    ctxt.stck.wide = std::get<Bign>(v);
+    return WIDE;
+}
+
+static Valu widen(Word n, const Ctxt& ctxt) {
+    if (n == WIDE) {
+        return Valu {std::move(ctxt.stck.wide)};
+    }
+    return Valu {n};
+}
+
+//
+// operands(n1,e2,defs,ctxt)
+//
+// Gives both operands of an int operation as values, once `eval_int` has
+// given WIDE for one of them: either for the first, `n1`, in which case
+// the second, `e2`, is evaluated now, or else for the second.
+//
+static std::pair<Valu,Valu> operands(Word n1, Expn_ptr e2, const Defs& defs, const Ctxt& ctxt) {
+    if (n1 == WIDE) {
+        Valu v1 = widen(n1, ctxt);
+        return {std::move(v1), e2->eval(defs,ctxt)};
+    }
+    return {Valu {n1}, widen(WIDE, ctxt)};
+}
+
+//
+// Arena, AST::operator new, AST::operator delete
+//
+// - allocation of syntax tree nodes. See the header (.hh) for details.
+//
+
+thread_local Arena* Arena::current = nullptr;
+
+Arena::~Arena(void) {
+    clear();
+}
+
+void Arena::clear(void) {
+    // Destroy the nodes in the reverse of the order they were made in.
+    for (auto n = nodes.rbegin(); n != nodes.rend(); n++) {
+        static_cast<AST*>(*n)->~AST();
+    }
+    nodes.clear();
+    for (char* b : blocks) {
+        delete[] b;
+    }
+    blocks.clear();
+    next = nullptr;
+    end = nullptr;
+}
+
+void* Arena::alloc(std::size_t size) {
+    // Keep every node aligned as `new` would.
+    constexpr std::size_t align = alignof(std::max_align_t);
+    size = (size + align - 1) & ~(align - 1);
+    if (size > static_cast<std::size_t>(end - next)) {
+        std::size_t bytes = std::max(size, BLOCK);
+        blocks.push_back(new char[bytes]);
+        next = blocks.back();
+        end = next + bytes;
+    }
+    void* p = next;
+    next += size;
+    nodes.push_back(p);
+    return p;
+}
+
+void Arena::unalloc(void* p) {
+    // Only called when the constructor of the most recent node throws.
+    if (!nodes.empty() && nodes.back() == p) {
+        nodes.pop_back();
+    }
+}
+
+void* AST::operator new(std::size_t size) {
+    if (!Arena::current) {
+        throw std::logic_error("AST node made with no arena in use.");
+    }
+    return Arena::current->alloc(size);
+}
+
+void AST::operator delete(void* p) {
+    // The memory itself goes when the arena does.
+    if (Arena::current) {
+        Arena::current->unalloc(p);
+    }
+}
+
+
+
+//
+// Memo::key, Memo::find, Memo::keep
+//
+// - the results kept for a pure definition. See the header (.hh) for
+//   details.
+//
+
+bool Memo::key(const Valu* args, std::size_t count, std::string& k) {
+    k.assign(1, static_cast<char>(count));
+    for (std::size_t i = 0; i < count; i++) {
+        const Valu& a = args[i];
+        k.push_back(static_cast<char>(a.index()));
+        if (const Word* n = std::get_if<Word>(&a)) {
+            k.append(reinterpret_cast<const char*>(n), sizeof(Word));
+        } else if (const bool* b = std::get_if<bool>(&a)) {
+            k.push_back(*b);
+        } else if (const Strg* s = std::get_if<Strg>(&a)) {
+            if (s->size() > KEY_MAX) return false;
+            std::size_t n = s->size();
+            k.append(reinterpret_cast<const char*>(&n), sizeof(n));
+            k.append(s->str());
+        } else if (const Bign* b = std::get_if<Bign>(&a)) {
+            std::string digits = b->str();
+            std::size_t n = digits.size();
+            k.append(reinterpret_cast<const char*>(&n), sizeof(n));
+            k.append(digits);
+        }
+        if (k.size() > KEY_MAX) return false;
+    }
+    return true;
+}
+
+const Valu* Memo::find(const std::string& k) const {
+    if (entries.empty()) {
+        return nullptr;
+    }
+    const Entry& e = entries[std::hash<std::string> {}(k) % SIZE];
+    return e.key == k ? &e.valu : nullptr;
+}
+
+void Memo::keep(std::string k, const Valu& v) {
+    if (entries.empty()) {
+        entries.resize(SIZE);
+    }
+    Entry& e = entries[std::hash<std::string> {}(k) % SIZE];
+    e.key = std::move(k);
+    e.valu = v;
+}
 
 // * * * * *
 // The DWISLPY interpreter
@@ -91,16 +385,44 @@ std::string to_repr(Valu v) {
 //    variables to their current values.
 //
 
-void Prgm::run(void) const {
-    Ctxt main_ctxt { };
+void Prgm::run(Tier* tier, unsigned int max_depth, bool memo, Prof* prof) const {
+    Stck stck { };
+    stck.tier = tier;
+    stck.prof = prof;
+    stck.max_depth = max_depth;
+    stck.stack_end = stack_limit();
+    stck.memo = memo;
+    if (memo) {
+        stck.memos.resize(defs.size());
+    }
+    Ctxt main_ctxt { stck, stck.push(main_symt.get_size()) };
     if (main) {
         main->exec(defs,main_ctxt);
     }
 }
 
+//
+// Prgm::run(s,stck)
+//
+// Executes a statement of a streamed main script in the main frame, at
+// the bottom of `stck`, after growing that frame to hold any variables
+// it introduced. Gives false if it returned, which ends the script.
+//
+bool Prgm::run(Stmt_ptr s, Stck& stck) const {
+    if (stck.top < main_symt.get_size()) {
+        stck.push(main_symt.get_size() - stck.top);
+    }
+    Ctxt main_ctxt { stck, 0 };
+    DWISLPY_STAT_STMT(s);
+    return !s->exec(defs,main_ctxt).has_value();
+}
+
 
 std::optional<Valu> Blck::exec(const Defs& defs, Ctxt& ctxt) const {
+    Prof* prof = ctxt.stck.prof;
     for (Stmt_ptr s : stmts) {
+        if (prof) prof->step(s);
+        DWISLPY_STAT_STMT(s);
         std::optional<Valu> rv = s->exec(defs,ctxt);
         if (rv.has_value()) {
             return rv;
@@ -111,12 +433,14 @@ std::optional<Valu> Blck::exec(const Defs& defs, Ctxt& ctxt) const {
 
 std::optional<Valu> Asgn::exec(const Defs& defs,
                                Ctxt& ctxt) const {
-    ctxt[name] = expn->eval(defs,ctxt);
+    DWISLPY_STAT(writes, 1);
+    ctxt[slot] = expn->eval(defs,ctxt);
     return std::nullopt;
 }
 
 std::optional<Valu> Ntro::exec(const Defs &defs, Ctxt &ctxt) const {
-    ctxt[name] = expn->eval(defs, ctxt);
+    DWISLPY_STAT(writes, 1);
+    ctxt[slot] = expn->eval(defs, ctxt);
     return std::nullopt;
 }
 
@@ -127,39 +451,82 @@ std::optional<Valu> Pass::exec([[maybe_unused]] const Defs& defs,
 }
   
 std::optional<Valu> Prnt::exec(const Defs& defs, Ctxt& ctxt) const {
+    Sink& out = Sink::in_use();
     if (expns.size()) {
-        std::cout << to_string(expns[0]->eval(defs,ctxt));
+        to_sink(out, expns[0]->eval(defs,ctxt));
     }
     for (size_t i = 1; i < expns.size(); i++) {
-        std::cout << " " << to_string(expns[i]->eval(defs,ctxt));
+        out.put(' ');
+        to_sink(out, expns[i]->eval(defs,ctxt));
     }
-    std::cout << std::endl;
+    out.end();
     return std::nullopt;
 }
 
 std::optional<Valu> Pleq::exec(const Defs& defs, Ctxt& ctxt) const {
-    Valu& val = ctxt[name];
-
-    if (std::holds_alternative<int>(val)) {
-        ctxt[name] = Valu(std::get<int>(val) + std::get<int>(expn->eval(defs,ctxt)));
-    } else if (std::holds_alternative<std::string>(val)) {
-        ctxt[name] = Valu(std::get<std::string>(val) + std::get<std::string>(expn->eval(defs,ctxt)));
+    DWISLPY_STAT(writes, 1);
+    if (is_int(expn->type)) {
+        // Bump an int in place (no `Valu` is built for the amount).
+        Word amount = expn->eval_int(defs,ctxt);
+        Valu& val = ctxt[slot];
+        Word* n = std::get_if<Word>(&val);
+        Word bumped = 0;
+        if (n && amount != WIDE && add_fits(*n, amount, bumped)) {
+            *n = bumped;
+        } else {
+            val = wide_add(val, widen(amount, ctxt));
+        }
+        return std::nullopt;
+    }
+    Valu rv = expn->eval(defs,ctxt);
+    Valu& val = ctxt[slot];
+
+    if (holds_int(val)) {
+        Word n = 0;
+        if (!std::holds_alternative<Word>(val) || !std::holds_alternative<Word>(rv)
+            || !add_fits(std::get<Word>(val), std::get<Word>(rv), n)) {
+            val = wide_add(val, rv);
+        } else {
+            val = Valu {n};
+        }
+    } else if (std::holds_alternative<Strg>(val)) {
+        std::get<Strg>(val).append(std::get<Strg>(rv));
     } else if (std::holds_alternative<bool>(val)) {
-        ctxt[name] = Valu(std::get<bool>(val) + std::get<bool>(expn->eval(defs,ctxt)));
+        val = Valu(std::get<bool>(val) + std::get<bool>(rv));
     }
     return std::nullopt;
 }
 
 
 std::optional<Valu> Mneq::exec(const Defs& defs, Ctxt& ctxt) const {
-    Valu& val = ctxt[name];
-
-    if (std::holds_alternative<int>(val)) {
-        ctxt[name] = Valu(std::get<int>(val) - std::get<int>(expn->eval(defs,ctxt)));
-    } else if (std::holds_alternative<std::string>(val)) {
+    DWISLPY_STAT(writes, 1);
+    if (is_int(expn->type)) {
+        Word amount = expn->eval_int(defs,ctxt);
+        Valu& val = ctxt[slot];
+        Word* n = std::get_if<Word>(&val);
+        Word bumped = 0;
+        if (n && amount != WIDE && sub_fits(*n, amount, bumped)) {
+            *n = bumped;
+        } else {
+            val = wide_sub(val, widen(amount, ctxt));
+        }
+        return std::nullopt;
+    }
+    Valu rv = expn->eval(defs,ctxt);
+    Valu& val = ctxt[slot];
+
+    if (holds_int(val)) {
+        Word n = 0;
+        if (!std::holds_alternative<Word>(val) || !std::holds_alternative<Word>(rv)
+            || !sub_fits(std::get<Word>(val), std::get<Word>(rv), n)) {
+            val = wide_sub(val, rv);
+        } else {
+            val = Valu {n};
+        }
+    } else if (std::holds_alternative<Strg>(val)) {
         throw std::logic_error("Cannot subtract strings");
     } else if (std::holds_alternative<bool>(val)) {
-        ctxt[name] = Valu(std::get<bool>(val) - std::get<bool>(expn->eval(defs,ctxt)));
+        val = Valu(std::get<bool>(val) - std::get<bool>(rv));
     }
     return std::nullopt;
 }
@@ -171,7 +538,7 @@ std::optional<Valu> Ifcd::exec([[maybe_unused]]const Defs& defs, [[maybe_unused]
 
 std::optional<Valu> Cond::exec(const Defs& defs, Ctxt& ctxt) const {
     for (auto ifcd : ifcds) {
-        if (std::get<bool>(ifcd->cond->eval(defs,ctxt))) {
+        if (ifcd->cond->test(defs,ctxt)) {
             return ifcd->body->exec(defs,ctxt);
         }
     }
@@ -198,18 +565,74 @@ std::optional<Valu> Elif::exec(const Defs& defs, Ctxt& ctxt) const {
 
 
 std::optional<Valu> Whil::exec(const Defs& defs, Ctxt& ctxt) const {
-    while (std::get<bool>(cond->eval(defs,ctxt))) {
-        body->exec(defs,ctxt);
+    Tier* tier = ctxt.stck.tier;
+    while (cond->test(defs,ctxt)) {
+        std::optional<Valu> rv = body->exec(defs,ctxt);
+        if (rv.has_value()) {
+            return rv;
+        }
+        if (tier && Tier::hot(heat)) {
+            // Run the rest of the loop as bytecode, from its test.
+            return tier->loop(*this, ctxt);
+        }
     }
     return std::nullopt;
 }
 
 
+std::optional<Valu> IntWhil::exec(const Defs& defs, Ctxt& ctxt) const {
+    Tier* tier = ctxt.stck.tier;
+    Word bound = limit->eval_int(defs,ctxt);
+    Valu bound_v = widen(bound, ctxt);
+    for (;;) {
+        //
+        // Compare the int to the bound directly when both fit in an
+        // `Word`, or else compare their comparison to 0.
+        //
+        const Valu& v = ctxt[slot];
+        DWISLPY_STAT(reads, 1);
+        Word i = 0;
+        Word b = 0;
+        if (std::holds_alternative<Word>(v) && bound != WIDE) {
+            i = std::get<Word>(v);
+            b = bound;
+        } else {
+            i = wide_cmp(v, bound_v);
+        }
+        bool holds = false;
+        switch (test) {
+        case LT: holds = i < b; break;
+        case LE: holds = i <= b; break;
+        case GT: holds = i > b; break;
+        case GE: holds = i >= b; break;
+        }
+        if (!holds) {
+            return std::nullopt;
+        }
+        std::optional<Valu> rv = body->exec(defs,ctxt);
+        if (rv.has_value()) {
+            return rv;
+        }
+        if (tier && Tier::hot(heat)) {
+            return tier->loop(*this, ctxt);
+        }
+    }
+}
+
+
 std::optional<Valu> Rept::exec(const Defs &defs, Ctxt &ctxt) const {
+    Tier* tier = ctxt.stck.tier;
     do {
-        body->exec(defs,ctxt);
-    } while (!std::get<bool>(cond->eval(defs,ctxt)));
-    return std::nullopt;
+        std::optional<Valu> rv = body->exec(defs,ctxt);
+        if (rv.has_value()) {
+            return rv;
+        }
+        if (cond->test(defs,ctxt)) {
+            return std::nullopt;
+        }
+    } while (!tier || !Tier::hot(heat));
+    // Run the rest of the loop as bytecode, from its body.
+    return tier->loop(*this, ctxt);
 }
 
 
@@ -218,7 +641,7 @@ std::optional<Valu> FRtn::exec(const Defs& defs, Ctxt& ctxt) const {
 }
 
 std::optional<Valu> PRtn::exec([[maybe_unused]]const Defs& defs, [[maybe_unused]]Ctxt& ctxt) const {
-    return std::nullopt;
+    return Valu {None};
 }
 
 
@@ -230,41 +653,85 @@ std::optional<Valu> PRtn::exec([[maybe_unused]]const Defs& defs, [[maybe_unused]
 //    (integer) value.
 //
 
+Word Expn::eval_int(const Defs& defs, const Ctxt& ctxt) const {
+    return narrow(eval(defs,ctxt), ctxt);
+}
+
+bool Expn::test(const Defs& defs, const Ctxt& ctxt) const {
+    return std::get<bool>(eval(defs,ctxt));
+}
+
 Valu Defn::exec(const Defs& defs, const Ctxt& ctxt, const Args_vec& vec) const {
-    Ctxt new_ctxt { ctxt };
     if (args.get_frmls_size() != vec.size()) {
         throw std::logic_error("Wrong number of arguments");
     }
 
+    //
+    // Push the callee's frame, then evaluate each argument in the
+    // caller's frame straight into the slot of its formal. (The formals
+    // occupy the first slots of the frame.)
+    //
+    // A memoized definition stays with the interpreter even when tiered,
+    // since it is its `Memo` that makes its calls cheap. Once the
+    // arguments are in place, a memoized call looks for a kept result.
+    //
+    Stck& stck = ctxt.stck;
+    char here;
+    if (++stck.depth > stck.max_depth
+        || reinterpret_cast<std::uintptr_t>(&here) < stck.stack_end) {
+        throw DwislpyError { where(), "Run-time error: maximum call depth exceeded." };
+    }
+    DWISLPY_STAT(calls, 1);
+    DWISLPY_STAT_MAX(depth, stck.depth);
+    bool memoized = memoize && stck.memo;
+    if (!memoized && stck.tier && Tier::hot(heat)) {
+        Valu rv = stck.tier->call(*this, ctxt, vec);
+        stck.depth--;
+        return rv;
+    }
+    Ctxt new_ctxt { stck, stck.push(args.get_size()) };
     for (size_t i = 0; i < args.get_frmls_size(); i++) {
-        new_ctxt[args.get_frml(i)->name] = vec[i]->eval(defs, ctxt);
+        new_ctxt[i] = vec[i]->eval(defs, ctxt);
+    }
+    DWISLPY_STAT(writes, args.get_frmls_size());
+    Prof* prof = stck.prof;
+    if (prof) prof->enter(*this);
+    std::string key {};
+    bool keyed = memoized
+        && Memo::key(stck.slots.data() + new_ctxt.base, args.get_frmls_size(), key);
+    if (keyed) {
+        if (const Valu* kept = stck.memos[index].find(key)) {
+            Valu rv = *kept;
+            if (prof) prof->leave();
+            stck.pop(new_ctxt.base);
+            stck.depth--;
+            return rv;
+        }
     }
-    // handle return later 
-    return body->exec(defs,new_ctxt).value_or(None);
+    Valu rv = body->exec(defs,new_ctxt).value_or(None);
+    if (prof) prof->leave();
+    stck.pop(new_ctxt.base);
+    stck.depth--;
+    if (keyed) {
+        stck.memos[index].keep(std::move(key), rv);
+    }
+    return rv;
 }
 
 
 Valu FCll::eval(const Defs& defs, const Ctxt& ctxt) const {
-    auto fn_iter = defs.find(name);
-    if (fn_iter == defs.end()) {
-        throw std::logic_error("Function not found");
-    }
-    return fn_iter->second->exec(defs, ctxt, args);
+    return defn->exec(defs, ctxt, args);
 }
 
 
 std::optional<Valu> PCll::exec(const Defs& defs, Ctxt& ctxt) const {
-    auto fn_iter = defs.find(name);
-    if (fn_iter == defs.end()) {
-        throw std::logic_error("Function not found");
-    }
-   fn_iter->second->exec(defs, ctxt, args);
-   return std::nullopt;
+    defn->exec(defs, ctxt, args);
+    return std::nullopt;
 }
 
 
 Valu Inif::eval(const Defs& defs, const Ctxt& ctxt) const {
-    if (std::get<bool>(cond->eval(defs, ctxt))) {
+    if (cond->test(defs, ctxt)) {
         return if_br->eval(defs, ctxt); 
     } else {
         return else_br->eval(defs, ctxt);
@@ -272,46 +739,126 @@ Valu Inif::eval(const Defs& defs, const Ctxt& ctxt) const {
 }
 
 Valu Negt::eval(const Defs& defs, const Ctxt& ctxt) const {
-    return Valu(!std::get<bool>(expn->eval(defs,ctxt)));
+    return Valu(test(defs,ctxt));
+}
+
+bool Negt::test(const Defs& defs, const Ctxt& ctxt) const {
+    return !expn->test(defs,ctxt);
 }
 
 Valu Imus::eval(const Defs& defs, const Ctxt& ctxt) const {
-    return Valu(-std::get<int>(expn->eval(defs, ctxt)));
+    return widen(eval_int(defs, ctxt), ctxt);
+}
+
+Word Imus::eval_int(const Defs& defs, const Ctxt& ctxt) const {
+    Word n = expn->eval_int(defs, ctxt);
+    if (n == WIDE) {
+        return narrow(wide_neg(widen(n, ctxt)), ctxt);
+    }
+    return -n;
 }
 
 
 Valu Conj::eval(const Defs& defs, const Ctxt& ctxt) const {
-    return Valu(std::get<bool>(lft->eval(defs,ctxt)) && std::get<bool>(rht->eval(defs,ctxt)));
+    return Valu(test(defs,ctxt));
+};
+
+bool Conj::test(const Defs& defs, const Ctxt& ctxt) const {
+    return lft->test(defs,ctxt) && rht->test(defs,ctxt);
 };
 
 
 Valu Disj::eval(const Defs& defs, const Ctxt& ctxt) const {
-    return Valu(std::get<bool>(lft->eval(defs,ctxt)) || std::get<bool>(rht->eval(defs,ctxt)));
+    return Valu(test(defs,ctxt));
+};
+
+bool Disj::test(const Defs& defs, const Ctxt& ctxt) const {
+    return lft->test(defs,ctxt) || rht->test(defs,ctxt);
 };
 
 
 Valu Cmlt::eval(const Defs& defs, const Ctxt& ctxt) const {
-    return Valu(std::get<int>(lft->eval(defs,ctxt)) < std::get<int>(rht->eval(defs,ctxt)));
+    return Valu(test(defs,ctxt));
+};
+
+bool Cmlt::test(const Defs& defs, const Ctxt& ctxt) const {
+    Word ln = lft->eval_int(defs,ctxt);
+    if (ln != WIDE) {
+        Word rn = rht->eval_int(defs,ctxt);
+        if (rn != WIDE) {
+            return ln < rn;
+        }
+    }
+    auto [lv, rv] = operands(ln, rht, defs, ctxt);
+    return wide_cmp(lv, rv) < 0;
 };
 
 
 Valu Cmgt::eval(const Defs& defs, const Ctxt& ctxt) const {
-    return Valu(std::get<int>(lft->eval(defs,ctxt)) > std::get<int>(rht->eval(defs,ctxt)));
+    return Valu(test(defs,ctxt));
+};
+
+bool Cmgt::test(const Defs& defs, const Ctxt& ctxt) const {
+    Word ln = lft->eval_int(defs,ctxt);
+    if (ln != WIDE) {
+        Word rn = rht->eval_int(defs,ctxt);
+        if (rn != WIDE) {
+            return ln > rn;
+        }
+    }
+    auto [lv, rv] = operands(ln, rht, defs, ctxt);
+    return wide_cmp(lv, rv) > 0;
 };
 
 
 Valu Cmeq::eval(const Defs& defs, const Ctxt& ctxt) const {
-    return Valu(std::get<int>(lft->eval(defs,ctxt)) == std::get<int>(rht->eval(defs,ctxt)));
+    return Valu(test(defs,ctxt));
+};
+
+bool Cmeq::test(const Defs& defs, const Ctxt& ctxt) const {
+    Word ln = lft->eval_int(defs,ctxt);
+    if (ln != WIDE) {
+        Word rn = rht->eval_int(defs,ctxt);
+        if (rn != WIDE) {
+            return ln == rn;
+        }
+    }
+    auto [lv, rv] = operands(ln, rht, defs, ctxt);
+    return wide_cmp(lv, rv) == 0;
 };
 
 
 Valu Cmle::eval(const Defs& defs, const Ctxt& ctxt) const {
-    return Valu(std::get<int>(lft->eval(defs,ctxt)) <= std::get<int>(rht->eval(defs,ctxt)));
+    return Valu(test(defs,ctxt));
+};
+
+bool Cmle::test(const Defs& defs, const Ctxt& ctxt) const {
+    Word ln = lft->eval_int(defs,ctxt);
+    if (ln != WIDE) {
+        Word rn = rht->eval_int(defs,ctxt);
+        if (rn != WIDE) {
+            return ln <= rn;
+        }
+    }
+    auto [lv, rv] = operands(ln, rht, defs, ctxt);
+    return wide_cmp(lv, rv) <= 0;
 };
 
 
 Valu Cmge::eval(const Defs& defs, const Ctxt& ctxt) const {
-    return Valu(std::get<int>(lft->eval(defs,ctxt)) >= std::get<int>(rht->eval(defs,ctxt)));
+    return Valu(test(defs,ctxt));
+};
+
+bool Cmge::test(const Defs& defs, const Ctxt& ctxt) const {
+    Word ln = lft->eval_int(defs,ctxt);
+    if (ln != WIDE) {
+        Word rn = rht->eval_int(defs,ctxt);
+        if (rn != WIDE) {
+            return ln >= rn;
+        }
+    }
+    auto [lv, rv] = operands(ln, rht, defs, ctxt);
+    return wide_cmp(lv, rv) >= 0;
 };
 
 
@@ -319,16 +866,19 @@ Valu Cmge::eval(const Defs& defs, const Ctxt& ctxt) const {
 Valu Plus::eval(const Defs& defs, const Ctxt& ctxt) const {
     Valu lv = left->eval(defs,ctxt);
     Valu rv = rght->eval(defs,ctxt);
-    if (std::holds_alternative<int>(lv)
-        && std::holds_alternative<int>(rv)) {
-        int ln = std::get<int>(lv);
-        int rn = std::get<int>(rv);
-        return Valu {ln + rn};
-    } else if (std::holds_alternative<std::string>(lv)
-               && std::holds_alternative<std::string>(rv)) {
-        std::string ls = std::get<std::string>(lv);
-        std::string rs = std::get<std::string>(rv);
-        return Valu {ls + rs};
+    if (std::holds_alternative<Word>(lv)
+        && std::holds_alternative<Word>(rv)) {
+        Word n = 0;
+        if (add_fits(std::get<Word>(lv), std::get<Word>(rv), n)) {
+            return Valu {n};
+        }
+        return wide_add(lv, rv);
+    } else if (std::holds_alternative<Strg>(lv)
+               && std::holds_alternative<Strg>(rv)) {
+        std::get<Strg>(lv).append(std::get<Strg>(rv));
+        return lv;
+    } else if (holds_int(lv) && holds_int(rv)) {
+        return wide_add(lv, rv);
     } else {
         std::string msg = "Run-time error: wrong operand type for plus.";
         throw DwislpyError { where(), msg };
@@ -338,11 +888,15 @@ Valu Plus::eval(const Defs& defs, const Ctxt& ctxt) const {
 Valu Mnus::eval(const Defs& defs, const Ctxt& ctxt) const {
     Valu lv = left->eval(defs,ctxt);
     Valu rv = rght->eval(defs,ctxt);
-    if (std::holds_alternative<int>(lv)
-        && std::holds_alternative<int>(rv)) {
-        int ln = std::get<int>(lv);
-        int rn = std::get<int>(rv);
-        return Valu {ln - rn};
+    if (std::holds_alternative<Word>(lv)
+        && std::holds_alternative<Word>(rv)) {
+        Word n = 0;
+        if (sub_fits(std::get<Word>(lv), std::get<Word>(rv), n)) {
+            return Valu {n};
+        }
+        return wide_sub(lv, rv);
+    } else if (holds_int(lv) && holds_int(rv)) {
+        return wide_sub(lv, rv);
     } else {
         std::string msg = "Run-time error: wrong operand type for minus.";
         throw DwislpyError { where(), msg };
@@ -352,21 +906,18 @@ Valu Mnus::eval(const Defs& defs, const Ctxt& ctxt) const {
 Valu Tmes::eval(const Defs& defs, const Ctxt& ctxt) const {
     Valu lv = left->eval(defs,ctxt);
     Valu rv = rght->eval(defs,ctxt);
-    if (std::holds_alternative<int>(lv)
-        && std::holds_alternative<int>(rv)) {
-        int ln = std::get<int>(lv);
-        int rn = std::get<int>(rv);
-        return Valu {ln * rn};
-    } else if (std::holds_alternative<std::string>(lv) && std::holds_alternative<int>(rv)) {
-        std::string ln = std::get<std::string>(lv);
-        int rn = std::get<int>(rv);
-        std::stringstream ss; 
-        for (int i = 0; i < rn; i++) {
-            ss << ln;
+    if (std::holds_alternative<Word>(lv)
+        && std::holds_alternative<Word>(rv)) {
+        Word n = 0;
+        if (mul_fits(std::get<Word>(lv), std::get<Word>(rv), n)) {
+            return Valu {n};
         }
-        return Valu {ss.str()};
-    } 
-    else {
+        return wide_mul(lv, rv);
+    } else if (std::holds_alternative<Strg>(lv) && holds_int(rv)) {
+        return Valu {repeat(std::get<Strg>(lv), rv, where())};
+    } else if (holds_int(lv) && holds_int(rv)) {
+        return wide_mul(lv, rv);
+    } else {
         // Exercise: make this work for (int,str) and (str,int).
         std::string msg = "Run-time error: wrong operand type for times.";
         throw DwislpyError { where(), msg };
@@ -376,15 +927,20 @@ Valu Tmes::eval(const Defs& defs, const Ctxt& ctxt) const {
 Valu IDiv::eval(const Defs& defs, const Ctxt& ctxt) const {
     Valu lv = left->eval(defs,ctxt);
     Valu rv = rght->eval(defs,ctxt);
-    if (std::holds_alternative<int>(lv)
-        && std::holds_alternative<int>(rv)) {
-        int ln = std::get<int>(lv);
-        int rn = std::get<int>(rv);
+    if (std::holds_alternative<Word>(lv)
+        && std::holds_alternative<Word>(rv)) {
+        Word ln = std::get<Word>(lv);
+        Word rn = std::get<Word>(rv);
         if (rn == 0) {
             throw DwislpyError { where(), "Run-time error: division by 0."};
         } else {
-            return Valu {ln / rn};
+            return Valu {floor_div(ln, rn)};
         } 
+    } else if (holds_int(lv) && holds_int(rv)) {
+        if (is_zero(rv)) {
+            throw DwislpyError { where(), "Run-time error: division by 0."};
+        }
+        return wide_div(lv, rv);
     } else {
         std::string msg = "Run-time error: wrong operand type for quotient.";
         throw DwislpyError { where(), msg };
@@ -394,46 +950,182 @@ Valu IDiv::eval(const Defs& defs, const Ctxt& ctxt) const {
 Valu IMod::eval(const Defs& defs, const Ctxt& ctxt) const {
     Valu lv = left->eval(defs,ctxt);
     Valu rv = rght->eval(defs,ctxt);
-    if (std::holds_alternative<int>(lv)
-        && std::holds_alternative<int>(rv)) {
-        int ln = std::get<int>(lv);
-        int rn = std::get<int>(rv);
+    if (std::holds_alternative<Word>(lv)
+        && std::holds_alternative<Word>(rv)) {
+        Word ln = std::get<Word>(lv);
+        Word rn = std::get<Word>(rv);
         if (rn == 0) {
             throw DwislpyError { where(), "Run-time error: division by 0."};
         } else {
-            return Valu {ln % rn};
+            return Valu {floor_mod(ln, rn)};
         } 
+    } else if (holds_int(lv) && holds_int(rv)) {
+        if (is_zero(rv)) {
+            throw DwislpyError { where(), "Run-time error: division by 0."};
+        }
+        return wide_mod(lv, rv);
     } else {
         std::string msg = "Run-time error: wrong operand type for remainder.";
         throw DwislpyError { where(), msg };
     }        
 }
+
+//
+// The specialized nodes made by Prgm::spcl. Their operands have been
+// checked, so these evaluate them without testing their types.
+//
+
+Valu IntPlus::eval(const Defs& defs, const Ctxt& ctxt) const {
+    return widen(eval_int(defs,ctxt), ctxt);
+}
+
+Word IntPlus::eval_int(const Defs& defs, const Ctxt& ctxt) const {
+    Word ln = left->eval_int(defs,ctxt);
+    if (ln != WIDE) {
+        Word rn = rght->eval_int(defs,ctxt);
+        Word n = 0;
+        if (rn != WIDE) {
+            return add_fits(ln, rn, n) ? n : narrow(wide_add(Valu {ln}, Valu {rn}), ctxt);
+        }
+    }
+    auto [lv, rv] = operands(ln, rght, defs, ctxt);
+    return narrow(wide_add(lv, rv), ctxt);
+}
+
+Valu StrPlus::eval(const Defs& defs, const Ctxt& ctxt) const {
+    //
+    // Evaluate the whole chain of operands first, so that the result
+    // can be built with one allocation of exactly the right length.
+    //
+    std::vector<Valu> vs;
+    vs.reserve(parts.size());
+    std::size_t length = 0;
+    for (Expn_ptr e : parts) {
+        vs.push_back(e->eval(defs,ctxt));
+        length += std::get<Strg>(vs.back()).size();
+    }
+    std::string s;
+    s.reserve(length);
+    for (const Valu& v : vs) {
+        s += std::get<Strg>(v).str();
+    }
+    return Valu {Strg {std::move(s)}};
+}
+
+Valu IntMnus::eval(const Defs& defs, const Ctxt& ctxt) const {
+    return widen(eval_int(defs,ctxt), ctxt);
+}
+
+Word IntMnus::eval_int(const Defs& defs, const Ctxt& ctxt) const {
+    Word ln = left->eval_int(defs,ctxt);
+    if (ln != WIDE) {
+        Word rn = rght->eval_int(defs,ctxt);
+        Word n = 0;
+        if (rn != WIDE) {
+            return sub_fits(ln, rn, n) ? n : narrow(wide_sub(Valu {ln}, Valu {rn}), ctxt);
+        }
+    }
+    auto [lv, rv] = operands(ln, rght, defs, ctxt);
+    return narrow(wide_sub(lv, rv), ctxt);
+}
+
+Valu IntTmes::eval(const Defs& defs, const Ctxt& ctxt) const {
+    return widen(eval_int(defs,ctxt), ctxt);
+}
+
+Word IntTmes::eval_int(const Defs& defs, const Ctxt& ctxt) const {
+    Word ln = left->eval_int(defs,ctxt);
+    if (ln != WIDE) {
+        Word rn = rght->eval_int(defs,ctxt);
+        Word n = 0;
+        if (rn != WIDE) {
+            return mul_fits(ln, rn, n) ? n : narrow(wide_mul(Valu {ln}, Valu {rn}), ctxt);
+        }
+    }
+    auto [lv, rv] = operands(ln, rght, defs, ctxt);
+    return narrow(wide_mul(lv, rv), ctxt);
+}
+
+Valu StrTmes::eval(const Defs& defs, const Ctxt& ctxt) const {
+    Valu lv = left->eval(defs,ctxt);
+    Word rn = rght->eval_int(defs,ctxt);
+    return Valu {repeat(std::get<Strg>(lv), widen(rn, ctxt), where())};
+}
+
+Valu IntIDiv::eval(const Defs& defs, const Ctxt& ctxt) const {
+    return widen(eval_int(defs,ctxt), ctxt);
+}
+
+Word IntIDiv::eval_int(const Defs& defs, const Ctxt& ctxt) const {
+    Word ln = left->eval_int(defs,ctxt);
+    if (ln != WIDE) {
+        Word rn = rght->eval_int(defs,ctxt);
+        if (rn == 0) {
+            throw DwislpyError { where(), "Run-time error: division by 0."};
+        } else if (rn != WIDE) {
+            return floor_div(ln, rn);
+        }
+    }
+    auto [lv, rv] = operands(ln, rght, defs, ctxt);
+    if (is_zero(rv)) {
+        throw DwislpyError { where(), "Run-time error: division by 0."};
+    }
+    return narrow(wide_div(lv, rv), ctxt);
+}
+
+Valu IntIMod::eval(const Defs& defs, const Ctxt& ctxt) const {
+    return widen(eval_int(defs,ctxt), ctxt);
+}
+
+Word IntIMod::eval_int(const Defs& defs, const Ctxt& ctxt) const {
+    Word ln = left->eval_int(defs,ctxt);
+    if (ln != WIDE) {
+        Word rn = rght->eval_int(defs,ctxt);
+        if (rn == 0) {
+            throw DwislpyError { where(), "Run-time error: division by 0."};
+        } else if (rn != WIDE) {
+            return floor_mod(ln, rn);
+        }
+    }
+    auto [lv, rv] = operands(ln, rght, defs, ctxt);
+    if (is_zero(rv)) {
+        throw DwislpyError { where(), "Run-time error: division by 0."};
+    }
+    return narrow(wide_mod(lv, rv), ctxt);
+}
 Valu Ltrl::eval([[maybe_unused]] const Defs& defs,
                 [[maybe_unused]] const Ctxt& ctxt) const {
     return valu;
 }
 
+Word Ltrl::eval_int([[maybe_unused]] const Defs& defs, const Ctxt& ctxt) const {
+    return narrow(valu, ctxt);
+}
+
+bool Ltrl::test([[maybe_unused]] const Defs& defs,
+                [[maybe_unused]] const Ctxt& ctxt) const {
+    return std::get<bool>(valu);
+}
+
 Valu Lkup::eval([[maybe_unused]] const Defs& defs, const Ctxt& ctxt) const {
-    if (ctxt.count(name) > 0) {
-        return ctxt.at(name);
-    } else {
-        std::string msg = "Run-time error: variable '" + name +"'";
-        msg += "not defined.";
-        throw DwislpyError { where(), msg };
-    }
+    DWISLPY_STAT(reads, 1);
+    return ctxt[slot];
+}
+
+Word Lkup::eval_int([[maybe_unused]] const Defs& defs, const Ctxt& ctxt) const {
+    DWISLPY_STAT(reads, 1);
+    return narrow(ctxt[slot], ctxt);
+}
+
+bool Lkup::test([[maybe_unused]] const Defs& defs, const Ctxt& ctxt) const {
+    DWISLPY_STAT(reads, 1);
+    return std::get<bool>(ctxt[slot]);
 }
 
 Valu Inpt::eval([[maybe_unused]] const Defs& defs, const Ctxt& ctxt) const {
     Valu v = expn->eval(defs,ctxt);
-    if (std::holds_alternative<std::string>(v)) {
-        //
-        std::string prompt = std::get<std::string>(v);
-        std::cout << prompt;
-        //
-        std::string vl;
-        std::cin >> vl;
-        //
-        return Valu {vl};
+    if (std::holds_alternative<Strg>(v)) {
+        return Valu {Feed::in_use().input(std::get<Strg>(v))};
     } else {
         std::string msg = "Run-time error: prompt is not a string.";
         throw DwislpyError { where(), msg };
@@ -446,18 +1138,17 @@ Valu IntC::eval([[maybe_unused]] const Defs& defs, const Ctxt& ctxt) const {
     // version of DWISLPY.
     //
     Valu v = expn->eval(defs,ctxt);
-    if (std::holds_alternative<int>(v)) {
+    if (holds_int(v)) {
         return Valu {v};
-    } else if (std::holds_alternative<std::string>(v)) {
-        std::string s = std::get<std::string>(v);
-        try {
-            int i = std::stoi(s);
-            return Valu {i};
-        } catch (std::invalid_argument e) {
+    } else if (std::holds_alternative<Strg>(v)) {
+        const std::string& s = std::get<Strg>(v).str();
+        Valu i {};
+        if (!parse_int(s, i)) {
             std::string msg = "Run-time error: \""+s+"\"";
             msg += "cannot be converted to an int.";
             throw DwislpyError { where(), msg };
         }
+        return i;
     } else if (std::holds_alternative<bool>(v)) {
         bool b = std::get<bool>(v);
         return Valu {b ? 1 : 0};
@@ -32,16 +32,95 @@
 #include <iostream>
 #include <variant>
 #include <optional>
+#include <algorithm>
+#include <string_view>
+#include <climits>
 #include "dwislpy-util.hh"
+#include "dwislpy-bign.hh"
 #include "dwislpy-check.hh"
 
 // Valu
 //
 // The return type of `eval` and of literal values.
-// Note: the type `none` is defined in *-util.hh.
+// Note: the types `none` and `Strg` are defined in *-util.hh, and `Bign`
+// in *-bign.hh.
 //
-typedef std::variant<int, bool, std::string, none> Valu;
+// Strings are held as a shared `Strg`, so a `Valu` is a tag and a word,
+// and copying one (e.g. by looking up a variable) never allocates.
+//
+// An int is held as a `Word`, the integer of a machine word, whenever it
+// fits in one other than WIDE (its least value), and as a `Bign` only
+// when it doesn't. Each int has just the one form, so two ints of
+// different forms are never equal, and a `Word` never needs testing for
+// WIDE before it is negated or divided.
+//
+typedef long long Word;
+typedef std::variant<Word, bool, Strg, none, Bign> Valu;
 typedef std::optional<Valu> RtnO;
+static_assert(sizeof(Valu) <= 2 * sizeof(void*), "Valu should be two words");
+
+// Conversions of values to their printed and source-code forms, and
+// output of a value as it is printed. See dwislpy-ast.cc.
+std::string to_string(const Valu& v);
+std::string to_repr(const Valu& v);
+void to_stream(std::ostream& os, const Valu& v);
+void to_sink(Sink& out, const Valu& v);
+
+//
+// Arithmetic on ints.
+//
+// The `..._fits` functions do an operation on two `Word`s, giving whether
+// its result fits in a `Word` as well. Where it doesn't, the `wide_...`
+// function for it (see dwislpy-ast.cc) gives the result instead, from
+// operands of either form. These divide as Python does, rounding down,
+// and none of them checks for division by zero.
+//
+// `parse_int(s,v)` reads `s` as `int(s)` does, giving whether it could.
+// `repeat(s,v,lo)` gives `s * v` for an int of either form, and raises
+// an error located at `lo` for one too big for the string to be made.
+//
+constexpr Word WIDE = LLONG_MIN;
+
+inline bool holds_int(const Valu& v) {
+    return std::holds_alternative<Word>(v) || std::holds_alternative<Bign>(v);
+}
+
+inline bool is_zero(const Valu& v) { // A `Bign` is never 0.
+    const Word* n = std::get_if<Word>(&v);
+    return n && *n == 0;
+}
+
+inline bool add_fits(Word n1, Word n2, Word& n) {
+    return !__builtin_add_overflow(n1, n2, &n) && n != WIDE;
+}
+
+inline bool sub_fits(Word n1, Word n2, Word& n) {
+    return !__builtin_sub_overflow(n1, n2, &n) && n != WIDE;
+}
+
+inline bool mul_fits(Word n1, Word n2, Word& n) {
+    return !__builtin_mul_overflow(n1, n2, &n) && n != WIDE;
+}
+
+inline Word floor_div(Word n1, Word n2) {
+    Word q = n1 / n2;
+    return (n1 % n2 != 0 && (n1 < 0) != (n2 < 0)) ? q - 1 : q;
+}
+
+inline Word floor_mod(Word n1, Word n2) {
+    Word r = n1 % n2;
+    return (r != 0 && (r < 0) != (n2 < 0)) ? r + n2 : r;
+}
+
+Valu wide_add(const Valu& v1, const Valu& v2);
+Valu wide_sub(const Valu& v1, const Valu& v2);
+Valu wide_mul(const Valu& v1, const Valu& v2);
+Valu wide_div(const Valu& v1, const Valu& v2);
+Valu wide_mod(const Valu& v1, const Valu& v2);
+Valu wide_neg(const Valu& v);
+int wide_cmp(const Valu& v1, const Valu& v2);
+bool parse_int(std::string_view s, Valu& v);
+Strg repeat(const Strg& s, const Valu& v, Locn lo);
 
 //
 // We "pre-declare" each AST subclass for mutually recursive definitions.
@@ -50,6 +129,10 @@ typedef std::optional<Valu> RtnO;
 class Prgm;
 class Defn;
 class Blck;
+class Bytc; // See dwislpy-vm.hh.
+class Cgen; // See dwislpy-cgen.hh.
+class Tier; // See dwislpy-vm.hh.
+class Prof; // See dwislpy-prof.hh.
 //
 class Stmt;
 class Pass;
@@ -105,57 +188,206 @@ class FRtn;
 //
 
 typedef std::string Name;
-typedef std::unordered_map<Name,Valu> Ctxt;
-//
-typedef std::shared_ptr<Lkup> Lkup_ptr; 
-typedef std::shared_ptr<Ltrl> Ltrl_ptr; 
-typedef std::shared_ptr<IntC> IntC_ptr; 
-typedef std::shared_ptr<StrC> StrC_ptr; 
-typedef std::shared_ptr<Inpt> Inpt_ptr; 
-typedef std::shared_ptr<Plus> Plus_ptr; 
-typedef std::shared_ptr<Mnus> Mnus_ptr; 
-typedef std::shared_ptr<Tmes> Tmes_ptr;
-typedef std::shared_ptr<IDiv> IDiv_ptr;
-typedef std::shared_ptr<IMod> IMod_ptr;
-
-
-typedef std::shared_ptr<Ifcd> Ifcd_ptr;
-typedef std::shared_ptr<Inif> Inif_ptr;
-typedef std::shared_ptr<Else> Else_ptr;
-typedef std::shared_ptr<Elif> Elif_ptr;
-typedef std::shared_ptr<Whil> Whil_ptr;
-typedef std::shared_ptr<Rept> Rept_ptr;
-typedef std::shared_ptr<Coma> Coma_ptr;
-typedef std::shared_ptr<Coln> Coln_ptr;
-typedef std::shared_ptr<Pleq> Pleq_ptr;
-typedef std::shared_ptr<Mneq> Mneq_ptr;
-typedef std::shared_ptr<Negt> Negt_ptr;
-typedef std::shared_ptr<Imus> Imus_ptr;
-typedef std::shared_ptr<Conj> Conj_ptr;
-typedef std::shared_ptr<Disj> Disj_ptr;
-typedef std::shared_ptr<Cmlt> Cmlt_ptr;
-typedef std::shared_ptr<Cmgt> Cmgt_ptr;
-typedef std::shared_ptr<Cmeq> Cmeq_ptr;
-typedef std::shared_ptr<Cmle> Cmle_ptr;
-typedef std::shared_ptr<Cmge> Cmge_ptr;
-typedef std::shared_ptr<PCll> PCll_ptr;
-typedef std::shared_ptr<FCll> FCll_ptr;
-
-//
-typedef std::shared_ptr<Pass> Pass_ptr; 
-typedef std::shared_ptr<Prnt> Prnt_ptr; 
-typedef std::shared_ptr<Ntro> Ntro_ptr;
-typedef std::shared_ptr<Asgn> Asgn_ptr;
-typedef std::shared_ptr<PCll> PCll_ptr;
-typedef std::shared_ptr<PRtn> PRtn_ptr;
-typedef std::shared_ptr<FRtn> FRtn_ptr;
-//
-typedef std::shared_ptr<Prgm> Prgm_ptr; 
-typedef std::shared_ptr<Defn> Defn_ptr; 
-typedef std::shared_ptr<Blck> Blck_ptr; 
-typedef std::shared_ptr<Stmt> Stmt_ptr; 
-typedef std::shared_ptr<Expn> Expn_ptr;
-typedef std::shared_ptr<Cond> Cond_ptr;
+
+//
+// The most calls that the interpreter can have in progress at once,
+// unless changed by --max-depth.
+//
+constexpr unsigned int MAX_DEPTH = 1000;
+
+//
+// class Memo
+//
+// The results of the calls so far of a pure definition (see Defn::pure)
+// keyed by the values of their arguments, so that the interpreter can
+// skip calls it has made before. A key packs the type and value of each
+// argument into a string, and it is only made for arguments that pack
+// into at most KEY_MAX bytes.
+//
+// The table has a fixed number of entries, SIZE, and a key can only be
+// kept in the one entry its hash picks. Keeping a new result there
+// drops the one kept there before, so a table never grows.
+//
+class Memo {
+public:
+    static constexpr std::size_t SIZE = 4096;
+    static constexpr std::size_t KEY_MAX = 64;
+    static bool key(const Valu* args, std::size_t count, std::string& k);
+    const Valu* find(const std::string& k) const;
+    void keep(std::string k, const Valu& v);
+private:
+    struct Entry {
+        std::string key; // Empty when the entry is unused.
+        Valu valu;
+    };
+    std::vector<Entry> entries; // No entries until a first `keep`.
+};
+
+//
+// class Stck
+//
+// The stack of run-time frames used by the interpreter. Every frame is
+// a run of slots within the one contiguous vector `slots`. A call pushes
+// a frame just big enough for the formals and locals of its definition
+// and popping it only moves `top` back, so a call costs nothing that
+// depends on the state of its caller. The values left in popped slots
+// are simply overwritten when those slots are used again.
+//
+// When running with `--tiered`, `tier` is what hot code gets handed to.
+// When running with `--profile`, `prof` is told what gets run.
+// Unless run with `--no-memo`, `memo` lets calls of pure definitions be
+// looked up in `memos`, which holds a `Memo` for each definition (by its
+// `index`). These are kept with the run rather than the definition, so
+// that a program is never changed by running it.
+//
+// Each call made by the interpreter also nests a few C++ calls, so the
+// number in progress, `depth`, is limited to `max_depth`, and the C++
+// stack may not grow below `stack_end` (see `stack_limit`). Which bound
+// a deep recursion meets first depends on how much C++ stack each of
+// its calls takes, but going past either is a run-time error rather than
+// an overflow of the C++ stack. So a --max-depth bigger than the stack
+// can hold is, in effect, cut down to what it can.
+//
+// An `eval_int` whose int is not a `Word` (other than WIDE) gives WIDE, and
+// leaves the int in `wide` for its caller to take.
+//
+class Stck {
+public:
+    std::vector<Valu> slots;
+    std::size_t top = 0;
+    Tier* tier = nullptr;
+    Prof* prof = nullptr;
+    unsigned int depth = 0;
+    unsigned int max_depth = MAX_DEPTH;
+    std::uintptr_t stack_end = 0; // (0 for no bound.)
+    bool memo = true; // Whether to memoize calls (see Defn::memoize).
+    std::vector<Memo> memos;
+    Bign wide;
+    std::size_t push(unsigned int size) {
+        std::size_t base = top;
+        top += size;
+        if (top > slots.size()) {
+            slots.resize(std::max<std::size_t>(top, 2 * slots.size()));
+        }
+        return base;
+    }
+    void pop(std::size_t base) {
+        top = base;
+    }
+};
+
+//
+// class Ctxt
+//
+// The run-time frame of a function call or of the main script: the
+// slots of `stck` starting at `base`. Variables are resolved to slots
+// by `chck` (see SymT in *-check.hh), so `ctxt[slot]` is a variable.
+//
+// Note that the vector of slots can move when a frame is pushed, and
+// so references given by `ctxt[slot]` should not be held across calls.
+//
+class Ctxt {
+public:
+    Stck& stck;
+    std::size_t base;
+    Ctxt(Stck& st, std::size_t bs) : stck {st}, base {bs} { }
+    Valu& operator[](int slot) const {
+        return stck.slots[base + slot];
+    }
+};
+//
+// class Arena
+//
+// The nodes of a syntax tree are allocated from an arena, one per
+// `Driver`, rather than each on its own. They are bumped off the end of
+// a series of large blocks, so that the nodes of a body end up next to
+// each other, and they are then all destroyed together with the arena.
+// So the `_ptr` types below are plain (non-owning) pointers; nothing
+// else ever deletes a node.
+//
+// Nodes are made with `new` as usual, which (see AST::operator new) takes
+// them from the arena that is in use. An arena is put in use for the
+// extent of an `Arena::Use` object, e.g. while parsing a program, or
+// while optimizing it, and that's the only time nodes can be made.
+//
+// An arena can also be cleared, destroying its nodes all at once, so
+// that it can be used for more (see Driver::stream).
+//
+class Arena {
+public:
+    Arena(void) = default;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    ~Arena(void);
+    void* alloc(std::size_t size);
+    void unalloc(void* p);
+    void clear(void);
+    //
+    class Use {
+    public:
+        Use(Arena& arena) : prev {current} { current = &arena; }
+        ~Use(void) { current = prev; }
+    private:
+        Arena* prev;
+    };
+    static thread_local Arena* current;
+private:
+    static constexpr std::size_t BLOCK = 64 * 1024;
+    std::vector<char*> blocks;
+    char* next = nullptr;
+    char* end = nullptr;
+    std::vector<void*> nodes; // Each node, to be destroyed.
+};
+//
+typedef Lkup* Lkup_ptr;
+typedef Ltrl* Ltrl_ptr;
+typedef IntC* IntC_ptr;
+typedef StrC* StrC_ptr;
+typedef Inpt* Inpt_ptr;
+typedef Plus* Plus_ptr;
+typedef Mnus* Mnus_ptr;
+typedef Tmes* Tmes_ptr;
+typedef IDiv* IDiv_ptr;
+typedef IMod* IMod_ptr;
+
+
+typedef Ifcd* Ifcd_ptr;
+typedef Inif* Inif_ptr;
+typedef Else* Else_ptr;
+typedef Elif* Elif_ptr;
+typedef Whil* Whil_ptr;
+typedef Rept* Rept_ptr;
+typedef Coma* Coma_ptr;
+typedef Coln* Coln_ptr;
+typedef Pleq* Pleq_ptr;
+typedef Mneq* Mneq_ptr;
+typedef Negt* Negt_ptr;
+typedef Imus* Imus_ptr;
+typedef Conj* Conj_ptr;
+typedef Disj* Disj_ptr;
+typedef Cmlt* Cmlt_ptr;
+typedef Cmgt* Cmgt_ptr;
+typedef Cmeq* Cmeq_ptr;
+typedef Cmle* Cmle_ptr;
+typedef Cmge* Cmge_ptr;
+typedef PCll* PCll_ptr;
+typedef FCll* FCll_ptr;
+
+//
+typedef Pass* Pass_ptr;
+typedef Prnt* Prnt_ptr;
+typedef Ntro* Ntro_ptr;
+typedef Asgn* Asgn_ptr;
+typedef PCll* PCll_ptr;
+typedef PRtn* PRtn_ptr;
+typedef FRtn* FRtn_ptr;
+//
+typedef Prgm* Prgm_ptr;
+typedef Defn* Defn_ptr;
+typedef Blck* Blck_ptr;
+typedef Stmt* Stmt_ptr;
+typedef Expn* Expn_ptr;
+typedef Cond* Cond_ptr;
 //
 typedef std::vector<Stmt_ptr> Stmt_vec;
 typedef std::vector<Expn_ptr> Expn_vec;
@@ -193,6 +425,8 @@ private:
 public:
     AST(Locn lo) : locn {lo} { }
     virtual ~AST(void) = default;
+    static void* operator new(std::size_t size);
+    static void operator delete(void* p);
     virtual void output(std::ostream& os) const = 0;
     virtual void dump(int level = 0) const = 0;
     Locn where(void) const { return locn; }
@@ -222,13 +456,24 @@ public:
     SymT main_symt;
     //
     Prgm(Defs ds, Blck_ptr mn, Locn lo) :
-        AST {lo}, defs {ds}, main {mn}, main_symt {} { }
+        AST {lo}, defs {std::move(ds)}, main {mn}, main_symt {} { }
     virtual ~Prgm(void) = default;
     //
     virtual void dump(int level = 0) const;
-    virtual void run(void) const; // Execute the program.
+    virtual void run(Tier* tier = nullptr, unsigned int max_depth = MAX_DEPTH,
+                     bool memo = true, Prof* prof = nullptr) const; // Execute the program.
     virtual void output(std::ostream& os) const; // Output formatted code.
-    void chck(void); // Check for type errors 
+    void chck(unsigned int jobs = 1); // Check for type errors 
+    void optm(int level); // Simplify checked code (see dwislpy-opt.cc).
+    void spcl(void); // Specialize checked code.
+    //
+    // For a main script streamed a statement at a time (see Driver::stream).
+    //
+    void chck(Stmt_ptr s); // Check a statement of it.
+    Stmt_vec optm(Stmt_ptr s, int level); // Simplify a checked one.
+    bool run(Stmt_ptr s, Stck& stck) const; // Execute one, giving whether to go on.
+    void emit(Bytc& bc) const; // Compile to bytecode.
+    void cgen(Cgen& cg) const; // Compile to C.
 };
 
 //
@@ -244,17 +489,38 @@ public:
     Fmag args;
     Blck_ptr body;
     Type ret_type;
-    Defn(Name name, Fmag args, Blck_ptr body, Type ret_type, Locn lo) :  AST {lo}, name {name}, args {args},body {body}, ret_type{ret_type} { }
+    std::vector<Type> sig; // Its formals' types, set by `sign`.
+    mutable unsigned int heat = 0; // Calls so far, when tiered.
+    //
+    // Found by `chck`: whether its body prints or inputs, or loops, and
+    // the definitions it calls. From these, Prgm::chck works out whether
+    // it is `pure`, i.e. neither it nor anything it calls prints or
+    // inputs, and so whether the interpreter should `memoize` its calls,
+    // i.e. it is pure and does enough (loops or calls) to be worth it.
+    //
+    bool effects = false;
+    bool loops = false;
+    std::vector<Defn_ptr> callees;
+    bool pure = false;
+    bool memoize = false;
+    unsigned int index = 0; // Its place in the source, set by Prgm::chck.
+    bool ready = false; // Checked, optimized, and specialized (see Prgm::spcl).
+    Defn(Name name, Fmag args, Blck_ptr body, Type ret_type, Locn lo) :  AST {lo}, name {std::move(name)}, args {std::move(args)}, body {body}, ret_type {ret_type} { }
     virtual ~Defn(void) = default;
     //
     virtual void dump(int level = 0) const;
     virtual void output(std::ostream& os) const; // Output formatted code.
     virtual void output(std::ostream& os, std::string indent) const; // Output formatted code.
-    virtual Valu exec(const Defs& defs, const Ctxt& ctxt, const Args_vec& vec = {}) const;
+    Valu exec(const Defs& defs, const Ctxt& ctxt, const Args_vec& vec = {}) const;
     Type returns(void) const;
     unsigned int arity(void) const;
-    SymInfo_ptr formal(int i) const;
+    const SymInfo* formal(int i) const;
+    void sign(void);
     void chck(Defs& defs);
+    void optm(int level);
+    void spcl(void);
+    void emit(Bytc& bc) const;
+    void cgen(Cgen& cg) const;
 };
 
 //
@@ -279,6 +545,15 @@ public:
 //
 //  * dump: output the syntax tree of the expression
 //
+//  * emit(bc): compile the statement into bytecode (see dwislpy-vm.hh)
+//
+//  * cgen(cg): compile the statement into C (see dwislpy-cgen.hh)
+//
+//  * optm(self,level): simplify the statement, giving the statements
+//        that should replace `self` (see dwislpy-opt.cc)
+//
+//  * spcl: specialize the expressions within the statement
+//
 class Stmt : public AST {
 public:
     Stmt(Locn lo) : AST {lo} { }
@@ -287,6 +562,10 @@ public:
     virtual void output(std::ostream& os, std::string indent) const = 0;
     virtual void output(std::ostream& os) const;
     virtual Rtns chck(Rtns expd, Defs& defs, SymT& symt) = 0;
+    virtual Stmt_vec optm(Stmt_ptr self, int level);
+    virtual void spcl(void) { }
+    virtual void emit(Bytc& bc) const = 0;
+    virtual void cgen(Cgen& cg) const = 0;
 };
 
 //
@@ -296,11 +575,16 @@ class Asgn : public Stmt {
 public:
     Name     name;
     Expn_ptr expn;
-    Asgn(Name x, Expn_ptr e, Locn l) : Stmt {l}, name {x}, expn {e} { }
+    int      slot = -1; // Frame slot of `name`, resolved by `chck`.
+    Asgn(Name x, Expn_ptr e, Locn l) : Stmt {l}, name {std::move(x)}, expn {e} { }
     virtual ~Asgn(void) = default;
     virtual std::optional<Valu> exec(const Defs& defs, Ctxt& ctxt) const;
     virtual void output(std::ostream& os, std::string indent) const;
     virtual void dump(int level = 0) const;
+    virtual void emit(Bytc& bc) const;
+    virtual void cgen(Cgen& cg) const;
+    virtual Stmt_vec optm(Stmt_ptr self, int level);
+    virtual void spcl(void);
     virtual Rtns chck(Rtns expd, Defs& defs, SymT& symt);
 };
 
@@ -312,24 +596,34 @@ public:
     Name     name;
     Type type;
     Expn_ptr expn;
+    int      slot = -1; // Frame slot of `name`, resolved by `chck`.
     Ntro(Name x, Type t, Expn_ptr e, Locn l) :
-        Stmt {l}, name {x}, type {t},expn {e} { }
+        Stmt {l}, name {std::move(x)}, type {t}, expn {e} { }
     virtual ~Ntro(void) = default;
     virtual Rtns chck(Rtns expd, Defs& defs, SymT& symt);
     virtual std::optional<Valu> exec(const Defs& defs, Ctxt& ctxt) const;
     virtual void output(std::ostream& os, std::string indent) const;
     virtual void dump(int level = 0) const;
+    virtual void emit(Bytc& bc) const;
+    virtual void cgen(Cgen& cg) const;
+    virtual Stmt_vec optm(Stmt_ptr self, int level);
+    virtual void spcl(void);
 };
 
 class Pleq : public Stmt {
 public:
     Name     name;
     Expn_ptr expn;
-    Pleq(Name x, Expn_ptr e, Locn l) : Stmt {l}, name {x}, expn {e} { }
+    int      slot = -1; // Frame slot of `name`, resolved by `chck`.
+    Pleq(Name x, Expn_ptr e, Locn l) : Stmt {l}, name {std::move(x)}, expn {e} { }
     virtual ~Pleq(void) = default;
     virtual std::optional<Valu> exec(const Defs& defs, Ctxt& ctxt) const;
     virtual void output(std::ostream& os, std::string indent) const;
     virtual void dump(int level = 0) const;
+    virtual void emit(Bytc& bc) const;
+    virtual void cgen(Cgen& cg) const;
+    virtual Stmt_vec optm(Stmt_ptr self, int level);
+    virtual void spcl(void);
     virtual Rtns chck([[maybe_unused]]Rtns expd, [[maybe_unused]]Defs& defs, [[maybe_unused]]SymT& symt);
 };
 
@@ -337,11 +631,16 @@ class Mneq : public Stmt {
 public:
     Name     name;
     Expn_ptr expn;
-    Mneq(Name x, Expn_ptr e, Locn l) : Stmt {l}, name {x}, expn {e} { }
+    int      slot = -1; // Frame slot of `name`, resolved by `chck`.
+    Mneq(Name x, Expn_ptr e, Locn l) : Stmt {l}, name {std::move(x)}, expn {e} { }
     virtual ~Mneq(void) = default;
     virtual std::optional<Valu> exec(const Defs& defs, Ctxt& ctxt) const;
     virtual void output(std::ostream& os, std::string indent) const;
     virtual void dump(int level = 0) const;
+    virtual void emit(Bytc& bc) const;
+    virtual void cgen(Cgen& cg) const;
+    virtual Stmt_vec optm(Stmt_ptr self, int level);
+    virtual void spcl(void);
     virtual Rtns chck([[maybe_unused]]Rtns expd, [[maybe_unused]]Defs& defs, [[maybe_unused]]SymT& symt);
 };
 
@@ -349,12 +648,16 @@ class Cond : public Stmt {
     public: 
         Ifcd_vec ifcds;
         Else_ptr els;
-    Cond(Ifcd_vec v, Else_ptr e, Locn l) : Stmt {l}, ifcds {v}, els {e} { }
-    Cond(Ifcd_vec v, Locn l) : Stmt {l}, ifcds {v}, els {nullptr} {} 
+    Cond(Ifcd_vec v, Else_ptr e, Locn l) : Stmt {l}, ifcds {std::move(v)}, els {e} { }
+    Cond(Ifcd_vec v, Locn l) : Stmt {l}, ifcds {std::move(v)}, els {nullptr} { }
     virtual ~Cond(void) = default;
     virtual std::optional<Valu> exec(const Defs& defs, Ctxt& ctxt) const;
     virtual void output(std::ostream& os, std::string indent) const;
     virtual void dump(int level = 0) const;
+    virtual void emit(Bytc& bc) const;
+    virtual void cgen(Cgen& cg) const;
+    virtual Stmt_vec optm(Stmt_ptr self, int level);
+    virtual void spcl(void);
     virtual Rtns chck(Rtns expd, Defs& defs, SymT& symt);
 };
 
@@ -367,6 +670,9 @@ public:
     virtual std::optional<Valu> exec(const Defs& defs, Ctxt& ctxt) const;
     virtual void output(std::ostream& os, std::string indent) const;
     virtual void dump(int level = 0) const;
+    virtual void emit(Bytc& bc) const;
+    virtual void cgen(Cgen& cg) const;
+    virtual void spcl(void);
     virtual Rtns chck([[maybe_unused]]Rtns expd, [[maybe_unused]]Defs& defs, [[maybe_unused]]SymT& symt);
 };
 
@@ -379,6 +685,9 @@ public:
     virtual std::optional<Valu> exec(const Defs& defs, Ctxt& ctxt) const;
     virtual void output(std::ostream& os, std::string indent) const;
     virtual void dump(int level = 0) const;
+    virtual void emit(Bytc& bc) const;
+    virtual void cgen(Cgen& cg) const;
+    virtual void spcl(void);
     virtual Rtns chck([[maybe_unused]]Rtns expd, [[maybe_unused]]Defs& defs, [[maybe_unused]]SymT& symt);
 };
 
@@ -390,6 +699,8 @@ public:
     virtual std::optional<Valu> exec(const Defs& defs, Ctxt& ctxt) const;
     virtual void output(std::ostream& os, std::string indent) const;
     virtual void dump(int level = 0) const;
+    virtual void emit(Bytc& bc) const;
+    virtual void cgen(Cgen& cg) const;
     virtual Rtns chck([[maybe_unused]]Rtns expd, [[maybe_unused]]Defs& defs, [[maybe_unused]]SymT& symt);
 };
 
@@ -398,11 +709,16 @@ class Whil : public Stmt {
 public:
     Expn_ptr cond;
     Blck_ptr body;
+    mutable unsigned int heat = 0; // Iterations so far, when tiered.
     Whil(Expn_ptr c, Blck_ptr b, Locn l) : Stmt {l}, cond {c}, body {b} { }
     virtual ~Whil(void) = default;
     virtual std::optional<Valu> exec(const Defs& defs, Ctxt& ctxt) const;
     virtual void output(std::ostream& os, std::string indent) const;
     virtual void dump(int level = 0) const;
+    virtual void emit(Bytc& bc) const;
+    virtual void cgen(Cgen& cg) const;
+    virtual Stmt_vec optm(Stmt_ptr self, int level);
+    virtual void spcl(void);
     virtual Rtns chck(Rtns expd, Defs& defs, SymT& symt);
 };
 
@@ -410,11 +726,16 @@ class Rept : public Stmt {
     public: 
         Expn_ptr cond;
         Blck_ptr body;
+        mutable unsigned int heat = 0; // Iterations so far, when tiered.
         Rept(Expn_ptr c, Blck_ptr b, Locn l) : Stmt {l}, cond {c}, body {b} { }
         virtual ~Rept(void) = default;
         virtual std::optional<Valu> exec(const Defs& defs, Ctxt& ctxt) const;
         virtual void output(std::ostream& os, std::string indent) const;
         virtual void dump(int level = 0) const;
+        virtual void emit(Bytc& bc) const;
+        virtual void cgen(Cgen& cg) const;
+        virtual Stmt_vec optm(Stmt_ptr self, int level);
+        virtual void spcl(void);
         virtual Rtns chck([[maybe_unused]]Rtns expd, [[maybe_unused]]Defs& defs, [[maybe_unused]]SymT& symt);
 };
 
@@ -427,6 +748,10 @@ public:
     virtual std::optional<Valu> exec(const Defs& defs, Ctxt& ctxt) const;
     void output(std::ostream& os, std::string indent) const;
     void dump(int level = 0) const;
+    virtual void emit(Bytc& bc) const;
+    virtual void cgen(Cgen& cg) const;
+    virtual Stmt_vec optm(Stmt_ptr self, int level);
+    virtual void spcl(void);
     virtual Rtns chck(Rtns expd, Defs& defs, SymT& symt);
 };
 
@@ -437,6 +762,8 @@ class PRtn : public Stmt {
     virtual std::optional<Valu> exec(const Defs& defs, Ctxt& ctxt) const;
     void output(std::ostream& os, std::string indent) const;
     void dump(int level = 0) const;
+    virtual void emit(Bytc& bc) const;
+    virtual void cgen(Cgen& cg) const;
     virtual Rtns chck(Rtns expd, Defs& defs, SymT& symt);
 };
 
@@ -446,11 +773,15 @@ class PRtn : public Stmt {
 class Prnt : public Stmt {
 public:
     Expn_vec expns;
-    Prnt(Expn_vec e, Locn l) : Stmt {l}, expns {e} { }
+    Prnt(Expn_vec e, Locn l) : Stmt {l}, expns {std::move(e)} { }
     virtual ~Prnt(void) = default;
     virtual std::optional<Valu> exec(const Defs& defs, Ctxt& ctxt) const;
     virtual void output(std::ostream& os, std::string indent) const;
     virtual void dump(int level = 0) const;
+    virtual void emit(Bytc& bc) const;
+    virtual void cgen(Cgen& cg) const;
+    virtual Stmt_vec optm(Stmt_ptr self, int level);
+    virtual void spcl(void);
     Rtns chck(Rtns expd, Defs& defs, SymT& symt);
 };
 
@@ -465,6 +796,8 @@ public:
     virtual std::optional<Valu> exec(const Defs& defs, Ctxt& ctxt) const;
     virtual void output(std::ostream& os, std::string indent) const;
     virtual void dump(int level = 0) const;
+    virtual void emit(Bytc& bc) const;
+    virtual void cgen(Cgen& cg) const;
     Rtns chck(Rtns expd, Defs& defs, SymT& symt);
 };
 
@@ -477,12 +810,16 @@ class Blck : public AST {
 public:
     Stmt_vec stmts;
     virtual ~Blck(void) = default;
-    Blck(Stmt_vec ss, Locn lo) : AST {lo}, stmts {ss}  { }
+    Blck(Stmt_vec ss, Locn lo) : AST {lo}, stmts {std::move(ss)}  { }
     virtual std::optional<Valu> exec(const Defs& defs, Ctxt& ctxt) const;
     virtual void output(std::ostream& os, std::string indent) const;
     virtual void output(std::ostream& os) const;
     virtual void dump(int level = 0) const;
     virtual Rtns chck(Rtns expd, Defs& defs, SymT& symt);
+    void optm(int level);
+    void spcl(void);
+    void emit(Bytc& bc) const;
+    void cgen(Cgen& cg) const;
 };
 
 
@@ -507,21 +844,38 @@ public:
 //  * eval(ctxt): evaluate the expression; return its result
 //  * output(os): output formatted DwiSlpy code of the expression.
 //  * dump: output the syntax tree of the expression
+//  * push(bc): compile code that pushes the expression's value
+//  * cexp(cg): compile C code for the expression, giving its C value
+//
+// Once checked, `type` holds the type of the expression's value. The
+// methods `eval_int` and `test` evaluate an expression known to be of
+// type int or bool, respectively, giving its value unwrapped. Nodes
+// override these where they can avoid building a `Valu`. `test` is
+// what conditions of `if`, `while`, and `repeat` use, so that, say,
+// `i < n` is compared and branched on directly. An int too big for an
+// `int` comes back from `eval_int` as WIDE, with it in `ctxt.stck.wide`
+// (see Stck).
+//
+// `optm(self,level)` and `spcl(self)` each give the node that should
+// replace `self` (see dwislpy-opt.cc and Prgm::spcl).
 //
 class Expn : public Stmt {
 public:
     bool is_statement = false;
+    Type type = NONE_T; // The type reported by `chck`.
     Expn(Locn lo) : Stmt {lo} { }
     virtual ~Expn(void) = default;
     std::optional<Valu> exec(const Defs& defs, Ctxt& ctxt) const final {
-        auto val = this->eval(defs, ctxt);
+        Valu val = this->eval(defs, ctxt);
 
         if (is_statement)
             return std::nullopt;
         else 
-            return this->eval(defs, ctxt);
+            return val;
     };
     virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const = 0;
+    virtual Word eval_int(const Defs& defs, const Ctxt& ctxt) const;
+    virtual bool test(const Defs& defs, const Ctxt& ctxt) const;
     virtual void output(std::ostream& os) const = 0;
     void output(std::ostream& os, std::string indent) const final {
         if (is_statement) {
@@ -542,6 +896,14 @@ public:
     }
     Rtns chck([[maybe_unused]]Rtns expd, [[maybe_unused]]Defs& defs, [[maybe_unused]]SymT& symt) final {throw DwislpyError{where(), "EXPN should not use Stmt check"};};
     virtual Type chck(Defs& defs, SymT& symt) = 0;
+    Stmt_vec optm([[maybe_unused]]Stmt_ptr self, [[maybe_unused]]int level) final {throw DwislpyError{where(), "EXPN should not use Stmt optm"};};
+    virtual Expn_ptr optm(Expn_ptr self, int level);
+    void spcl(void) final {throw DwislpyError{where(), "EXPN should not use Stmt spcl"};};
+    virtual Expn_ptr spcl(Expn_ptr self);
+    void emit(Bytc& bc) const final;
+    virtual void push(Bytc& bc) const = 0;
+    void cgen(Cgen& cg) const final;
+    virtual std::string cexp(Cgen& cg) const = 0;
 };
 
 class Inif : public Expn {
@@ -554,6 +916,10 @@ class Inif : public Expn {
         virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const;
         virtual void output(std::ostream& os) const;
         virtual void dump(int level = 0) const;
+        virtual void push(Bytc& bc) const;
+        virtual std::string cexp(Cgen& cg) const;
+        virtual Expn_ptr optm(Expn_ptr self, int level);
+        virtual Expn_ptr spcl(Expn_ptr self);
     Type chck(Defs& defs, SymT& symt);
 };
 
@@ -563,8 +929,13 @@ public:
     Negt(Expn_ptr e, Locn l) : Expn {l}, expn {e} { }
     virtual ~Negt(void) = default;
     virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const;
+    virtual bool test(const Defs& defs, const Ctxt& ctxt) const;
     virtual void output(std::ostream& os) const;
     virtual void dump(int level = 0) const;
+    virtual void push(Bytc& bc) const;
+    virtual std::string cexp(Cgen& cg) const;
+    virtual Expn_ptr optm(Expn_ptr self, int level);
+    virtual Expn_ptr spcl(Expn_ptr self);
     Type chck(Defs& defs, SymT& symt);
 };
 
@@ -574,8 +945,13 @@ public:
     Imus(Expn_ptr e, Locn l) : Expn {l}, expn {e} { }
     virtual ~Imus(void) = default;
     virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const;
+    virtual Word eval_int(const Defs& defs, const Ctxt& ctxt) const;
     virtual void output(std::ostream& os) const;
     virtual void dump(int level = 0) const;
+    virtual void push(Bytc& bc) const;
+    virtual std::string cexp(Cgen& cg) const;
+    virtual Expn_ptr optm(Expn_ptr self, int level);
+    virtual Expn_ptr spcl(Expn_ptr self);
     Type chck(Defs& defs, SymT& symt);
 };
 
@@ -587,8 +963,13 @@ public:
     Conj(Expn_ptr lft, Expn_ptr rht, Locn l) : Expn {l}, lft {lft}, rht {rht} { }
     virtual ~Conj(void) = default;
     virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const;
+    virtual bool test(const Defs& defs, const Ctxt& ctxt) const;
     virtual void output(std::ostream& os) const;
     virtual void dump(int level = 0) const;
+    virtual void push(Bytc& bc) const;
+    virtual std::string cexp(Cgen& cg) const;
+    virtual Expn_ptr optm(Expn_ptr self, int level);
+    virtual Expn_ptr spcl(Expn_ptr self);
     Type chck(Defs& defs, SymT& symt);
 };
 
@@ -600,8 +981,13 @@ public:
     Disj(Expn_ptr lft, Expn_ptr rht, Locn l) : Expn {l}, lft {lft}, rht {rht} { }
     virtual ~Disj(void) = default;
     virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const;
+    virtual bool test(const Defs& defs, const Ctxt& ctxt) const;
     virtual void output(std::ostream& os) const;
     virtual void dump(int level = 0) const;
+    virtual void push(Bytc& bc) const;
+    virtual std::string cexp(Cgen& cg) const;
+    virtual Expn_ptr optm(Expn_ptr self, int level);
+    virtual Expn_ptr spcl(Expn_ptr self);
     Type chck(Defs& defs, SymT& symt);
 };
 
@@ -613,8 +999,13 @@ public:
     Cmlt(Expn_ptr lft, Expn_ptr rht, Locn l) : Expn {l}, lft {lft}, rht {rht} { }
     virtual ~Cmlt(void) = default;
     virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const;
+    virtual bool test(const Defs& defs, const Ctxt& ctxt) const;
     virtual void output(std::ostream& os) const;
     virtual void dump(int level = 0) const;
+    virtual void push(Bytc& bc) const;
+    virtual std::string cexp(Cgen& cg) const;
+    virtual Expn_ptr optm(Expn_ptr self, int level);
+    virtual Expn_ptr spcl(Expn_ptr self);
     Type chck(Defs& defs, SymT& symt);
 };
 
@@ -626,8 +1017,13 @@ public:
     Cmgt(Expn_ptr lft, Expn_ptr rht, Locn l) : Expn {l}, lft {lft}, rht {rht} { }
     virtual ~Cmgt(void) = default;
     virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const;
+    virtual bool test(const Defs& defs, const Ctxt& ctxt) const;
     virtual void output(std::ostream& os) const;
     virtual void dump(int level = 0) const;
+    virtual void push(Bytc& bc) const;
+    virtual std::string cexp(Cgen& cg) const;
+    virtual Expn_ptr optm(Expn_ptr self, int level);
+    virtual Expn_ptr spcl(Expn_ptr self);
     Type chck(Defs& defs, SymT& symt);
 };
 
@@ -639,8 +1035,13 @@ public:
     Cmeq(Expn_ptr lft, Expn_ptr rht, Locn l) : Expn {l}, lft {lft}, rht {rht} { }
     virtual ~Cmeq(void) = default;
     virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const;
+    virtual bool test(const Defs& defs, const Ctxt& ctxt) const;
     virtual void output(std::ostream& os) const;
     virtual void dump(int level = 0) const;
+    virtual void push(Bytc& bc) const;
+    virtual std::string cexp(Cgen& cg) const;
+    virtual Expn_ptr optm(Expn_ptr self, int level);
+    virtual Expn_ptr spcl(Expn_ptr self);
     Type chck(Defs& defs, SymT& symt);
 };
 
@@ -652,8 +1053,13 @@ public:
     Cmle(Expn_ptr lft, Expn_ptr rht, Locn l) : Expn {l}, lft {lft}, rht {rht} { }
     virtual ~Cmle(void) = default;
     virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const;
+    virtual bool test(const Defs& defs, const Ctxt& ctxt) const;
     virtual void output(std::ostream& os) const;
     virtual void dump(int level = 0) const;
+    virtual void push(Bytc& bc) const;
+    virtual std::string cexp(Cgen& cg) const;
+    virtual Expn_ptr optm(Expn_ptr self, int level);
+    virtual Expn_ptr spcl(Expn_ptr self);
     Type chck(Defs& defs, SymT& symt);
 };
 
@@ -665,8 +1071,13 @@ public:
     Cmge(Expn_ptr lft, Expn_ptr rht, Locn l) : Expn {l}, lft {lft}, rht {rht} { }
     virtual ~Cmge(void) = default;
     virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const;
+    virtual bool test(const Defs& defs, const Ctxt& ctxt) const;
     virtual void output(std::ostream& os) const;
     virtual void dump(int level = 0) const;
+    virtual void push(Bytc& bc) const;
+    virtual std::string cexp(Cgen& cg) const;
+    virtual Expn_ptr optm(Expn_ptr self, int level);
+    virtual Expn_ptr spcl(Expn_ptr self);
     Type chck(Defs& defs, SymT& symt);
 };
 
@@ -675,11 +1086,16 @@ class FCll : public Expn {
     public: 
         Name name;
         Expn_vec args;
-        FCll(Name name, Expn_vec args, Locn l) : Expn {l}, name {name}, args {args} { }
+        Defn_ptr defn = nullptr; // The callee, bound by `chck`.
+        FCll(Name name, Expn_vec args, Locn l) : Expn {l}, name {std::move(name)}, args {std::move(args)} { }
         virtual ~FCll(void) = default;
         virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const;
         virtual void output(std::ostream& os) const;
         virtual void dump(int level = 0) const;
+        virtual void push(Bytc& bc) const;
+        virtual std::string cexp(Cgen& cg) const;
+        virtual Expn_ptr optm(Expn_ptr self, int level);
+        virtual Expn_ptr spcl(Expn_ptr self);
         Type chck(Defs& defs, SymT& symt);
 };
 
@@ -687,12 +1103,17 @@ class PCll : public Stmt {
 public:
     Name     name;
     Expn_vec args;
-    PCll(Name nm, Expn_vec args, Locn l) : Stmt {l}, name {nm}, args {args} { }
+    Defn_ptr defn = nullptr; // The callee, bound by `chck`.
+    PCll(Name nm, Expn_vec args, Locn l) : Stmt {l}, name {std::move(nm)}, args {std::move(args)} { }
     virtual ~PCll(void) = default;
     virtual Rtns chck(Rtns expd, Defs& defs, SymT& symt);
     virtual std::optional<Valu> exec(const Defs& defs, Ctxt& ctxt) const;
     virtual void output(std::ostream& os, std::string indent) const;
     virtual void dump(int level = 0) const;
+    virtual void emit(Bytc& bc) const;
+    virtual void cgen(Cgen& cg) const;
+    virtual Stmt_vec optm(Stmt_ptr self, int level);
+    virtual void spcl(void);
 };
 //
 // Plus - addition binary operation's AST node
@@ -707,6 +1128,10 @@ public:
     virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const;
     virtual void output(std::ostream& os) const;
     virtual void dump(int level = 0) const;
+    virtual void push(Bytc& bc) const;
+    virtual std::string cexp(Cgen& cg) const;
+    virtual Expn_ptr optm(Expn_ptr self, int level);
+    virtual Expn_ptr spcl(Expn_ptr self);
     Type chck(Defs& defs, SymT& symt);
 };
 
@@ -723,6 +1148,10 @@ public:
     virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const;
     virtual void output(std::ostream& os) const;
     virtual void dump(int level = 0) const;
+    virtual void push(Bytc& bc) const;
+    virtual std::string cexp(Cgen& cg) const;
+    virtual Expn_ptr optm(Expn_ptr self, int level);
+    virtual Expn_ptr spcl(Expn_ptr self);
     Type chck(Defs& defs, SymT& symt);
 };
 
@@ -739,6 +1168,10 @@ public:
     virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const;
     virtual void output(std::ostream& os) const;
     virtual void dump(int level = 0) const;
+    virtual void push(Bytc& bc) const;
+    virtual std::string cexp(Cgen& cg) const;
+    virtual Expn_ptr optm(Expn_ptr self, int level);
+    virtual Expn_ptr spcl(Expn_ptr self);
     virtual Type chck(Defs& defs, SymT& symt);
 };
 
@@ -755,6 +1188,10 @@ public:
     virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const;
     virtual void output(std::ostream& os) const;
     virtual void dump(int level = 0) const;
+    virtual void push(Bytc& bc) const;
+    virtual std::string cexp(Cgen& cg) const;
+    virtual Expn_ptr optm(Expn_ptr self, int level);
+    virtual Expn_ptr spcl(Expn_ptr self);
     virtual Type chck(Defs& defs, SymT& symt);
 };
 
@@ -771,6 +1208,10 @@ public:
     virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const;
     virtual void output(std::ostream& os) const;
     virtual void dump(int level = 0) const;
+    virtual void push(Bytc& bc) const;
+    virtual std::string cexp(Cgen& cg) const;
+    virtual Expn_ptr optm(Expn_ptr self, int level);
+    virtual Expn_ptr spcl(Expn_ptr self);
     virtual Type chck(Defs& defs, SymT& symt);
 };
 
@@ -780,11 +1221,17 @@ public:
 class Ltrl : public Expn {
 public:
     Valu valu;
-    Ltrl(Valu vl, Locn lo) : Expn {lo}, valu {vl} { }
+    Ltrl(Valu vl, Locn lo) : Expn {lo}, valu {std::move(vl)} {
+        if (Strg* s = std::get_if<Strg>(&valu)) s->share(); // (See Strg.)
+    }
     virtual ~Ltrl(void) = default;
     virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const;
+    virtual Word eval_int(const Defs& defs, const Ctxt& ctxt) const;
+    virtual bool test(const Defs& defs, const Ctxt& ctxt) const;
     virtual void output(std::ostream& os) const;
     virtual void dump(int level = 0) const;
+    virtual void push(Bytc& bc) const;
+    virtual std::string cexp(Cgen& cg) const;
     Type chck(Defs& defs, SymT& symt);
 };
 
@@ -795,11 +1242,16 @@ public:
 class Lkup : public Expn {
 public:
     Name name;
-    Lkup(Name nm, Locn lo) : Expn {lo}, name {nm} { }
+    int  slot = -1; // Frame slot of `name`, resolved by `chck`.
+    Lkup(Name nm, Locn lo) : Expn {lo}, name {std::move(nm)} { }
     virtual ~Lkup(void) = default;
     virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const;
+    virtual Word eval_int(const Defs& defs, const Ctxt& ctxt) const;
+    virtual bool test(const Defs& defs, const Ctxt& ctxt) const;
     virtual void output(std::ostream& os) const;
     virtual void dump(int level = 0) const;
+    virtual void push(Bytc& bc) const;
+    virtual std::string cexp(Cgen& cg) const;
     virtual Type chck(Defs& defs, SymT& symt);
 };
 
@@ -814,6 +1266,10 @@ public:
     virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const;
     virtual void output(std::ostream& os) const;
     virtual void dump(int level = 0) const;
+    virtual void push(Bytc& bc) const;
+    virtual std::string cexp(Cgen& cg) const;
+    virtual Expn_ptr optm(Expn_ptr self, int level);
+    virtual Expn_ptr spcl(Expn_ptr self);
     Type chck(Defs& defs, SymT& symt);
 };
 
@@ -828,6 +1284,10 @@ public:
     virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const;
     virtual void output(std::ostream& os) const;
     virtual void dump(int level = 0) const;
+    virtual void push(Bytc& bc) const;
+    virtual std::string cexp(Cgen& cg) const;
+    virtual Expn_ptr optm(Expn_ptr self, int level);
+    virtual Expn_ptr spcl(Expn_ptr self);
     Type chck(Defs& defs, SymT& symt);
 };
 
@@ -842,7 +1302,125 @@ public:
     virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const;
     virtual void output(std::ostream& os) const;
     virtual void dump(int level = 0) const;
+    virtual void push(Bytc& bc) const;
+    virtual std::string cexp(Cgen& cg) const;
+    virtual Expn_ptr optm(Expn_ptr self, int level);
+    virtual Expn_ptr spcl(Expn_ptr self);
     Type chck(Defs& defs, SymT& symt);
 };
 
+// ************************************************************
+//
+// Specialized expression nodes.
+//
+// Prgm::spcl replaces a checked Plus, Mnus, Tmes, IDiv, or IMod node by
+// one of these, according to the types of its operands. The `eval` of
+// each one skips the run-time type tests made by the generic node. The
+// integer ones compute with `eval_int` throughout, and so never build
+// a `Valu` for their operands, unless one is WIDE or their result
+// overflows. They compile to the same bytecode, and
+// they output and dump just like the node they replace.
+//
+
+//
+// IntPlus - int addition
+//
+class IntPlus : public Plus {
+public:
+    IntPlus(Expn_ptr lf, Expn_ptr rg, Locn lo) : Plus {lf, rg, lo} { }
+    virtual ~IntPlus(void) = default;
+    virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const;
+    virtual Word eval_int(const Defs& defs, const Ctxt& ctxt) const;
+};
+
+//
+// StrPlus - string concatenation (of a whole chain of `+`)
+//
+class StrPlus : public Plus {
+public:
+    Expn_vec parts; // Operands of the whole chain of `+`, left to right.
+    StrPlus(Expn_ptr lf, Expn_ptr rg, Locn lo) : Plus {lf, rg, lo} { }
+    virtual ~StrPlus(void) = default;
+    virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const;
+};
+
+//
+// IntMnus - int subtraction
+//
+class IntMnus : public Mnus {
+public:
+    IntMnus(Expn_ptr lf, Expn_ptr rg, Locn lo) : Mnus {lf, rg, lo} { }
+    virtual ~IntMnus(void) = default;
+    virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const;
+    virtual Word eval_int(const Defs& defs, const Ctxt& ctxt) const;
+};
+
+//
+// IntTmes - int multiplication
+//
+class IntTmes : public Tmes {
+public:
+    IntTmes(Expn_ptr lf, Expn_ptr rg, Locn lo) : Tmes {lf, rg, lo} { }
+    virtual ~IntTmes(void) = default;
+    virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const;
+    virtual Word eval_int(const Defs& defs, const Ctxt& ctxt) const;
+};
+
+//
+// StrTmes - string repetition
+//
+class StrTmes : public Tmes {
+public:
+    StrTmes(Expn_ptr lf, Expn_ptr rg, Locn lo) : Tmes {lf, rg, lo} { }
+    virtual ~StrTmes(void) = default;
+    virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const;
+};
+
+//
+// IntIDiv - int quotient
+//
+class IntIDiv : public IDiv {
+public:
+    IntIDiv(Expn_ptr lf, Expn_ptr rg, Locn lo) : IDiv {lf, rg, lo} { }
+    virtual ~IntIDiv(void) = default;
+    virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const;
+    virtual Word eval_int(const Defs& defs, const Ctxt& ctxt) const;
+};
+
+//
+// IntIMod - int remainder
+//
+class IntIMod : public IMod {
+public:
+    IntIMod(Expn_ptr lf, Expn_ptr rg, Locn lo) : IMod {lf, rg, lo} { }
+    virtual ~IntIMod(void) = default;
+    virtual Valu eval(const Defs& defs, const Ctxt& ctxt) const;
+    virtual Word eval_int(const Defs& defs, const Ctxt& ctxt) const;
+};
+
+// ************************************************************
+//
+// Specialized statement nodes.
+//
+// The optimizer replaces a `while` loop by this at -O3 (see `counted`
+// in dwislpy-opt.cc). Like the expression nodes above, it compiles,
+// outputs, and dumps just like the loop it replaces.
+//
+
+//
+// IntWhil - a `while` loop testing an int variable against a bound
+// that doesn't change while it runs
+//
+class IntWhil : public Whil {
+public:
+    enum Test { LT, LE, GT, GE };
+    int      slot;  // Frame slot of the variable tested.
+    Test     test;  // How it is compared with `limit`.
+    Expn_ptr limit; // A literal, or a variable the loop doesn't assign.
+    IntWhil(Expn_ptr c, Blck_ptr b, int s, Test t, Expn_ptr lm, Locn l) :
+        Whil {c, b, l}, slot {s}, test {t}, limit {lm} { }
+    virtual ~IntWhil(void) = default;
+    virtual std::optional<Valu> exec(const Defs& defs, Ctxt& ctxt) const;
+};
+
 #endif
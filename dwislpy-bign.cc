@@ -0,0 +1,325 @@
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include "dwislpy-bign.hh"
+
+//
+// dwislpy-bign.cc
+//
+// The arithmetic of big ints. See the header (.hh) file for details.
+//
+// The functions on magnitudes (`Limbs`) below work on their limbs
+// alone; the `Bign` operations work out the signs around them.
+//
+
+typedef std::vector<std::uint32_t> Limbs;
+
+static const std::uint64_t BASE = std::uint64_t {1} << 32;
+
+// The nine-digit chunks that a magnitude is read and written in.
+static const std::uint32_t CHUNK = 1000000000;
+static const std::size_t CHUNK_DIGITS = 9;
+
+static void trim(Limbs& a) {
+    while (!a.empty() && a.back() == 0) a.pop_back();
+}
+
+static int compare_mag(const Limbs& a, const Limbs& b) {
+    if (a.size() != b.size()) {
+        return a.size() < b.size() ? -1 : 1;
+    }
+    for (std::size_t i = a.size(); i-- > 0; ) {
+        if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+static Limbs add_mag(const Limbs& a, const Limbs& b) {
+    const Limbs& l = a.size() >= b.size() ? a : b;
+    const Limbs& s = a.size() >= b.size() ? b : a;
+    Limbs c(l.size() + 1);
+    std::uint64_t carry = 0;
+    for (std::size_t i = 0; i < l.size(); i++) {
+        std::uint64_t t = carry + l[i] + (i < s.size() ? s[i] : 0);
+        c[i] = static_cast<std::uint32_t>(t);
+        carry = t >> 32;
+    }
+    c[l.size()] = static_cast<std::uint32_t>(carry);
+    trim(c);
+    return c;
+}
+
+// Gives a - b, for a >= b.
+static Limbs sub_mag(const Limbs& a, const Limbs& b) {
+    Limbs c(a.size());
+    std::int64_t borrow = 0;
+    for (std::size_t i = 0; i < a.size(); i++) {
+        std::int64_t t = std::int64_t {a[i]} - borrow - (i < b.size() ? b[i] : 0);
+        borrow = t < 0;
+        c[i] = static_cast<std::uint32_t>(t + (borrow ? BASE : 0));
+    }
+    trim(c);
+    return c;
+}
+
+static Limbs mul_mag(const Limbs& a, const Limbs& b) {
+    if (a.empty() || b.empty()) {
+        return Limbs {};
+    }
+    Limbs c(a.size() + b.size());
+    for (std::size_t i = 0; i < a.size(); i++) {
+        std::uint64_t carry = 0;
+        for (std::size_t j = 0; j < b.size(); j++) {
+            std::uint64_t t = std::uint64_t {a[i]} * b[j] + c[i + j] + carry;
+            c[i + j] = static_cast<std::uint32_t>(t);
+            carry = t >> 32;
+        }
+        c[i + b.size()] = static_cast<std::uint32_t>(carry);
+    }
+    trim(c);
+    return c;
+}
+
+// Divides `a` by the single limb `d` in place, giving the remainder.
+static std::uint32_t div_limb(Limbs& a, std::uint32_t d) {
+    std::uint64_t r = 0;
+    for (std::size_t i = a.size(); i-- > 0; ) {
+        std::uint64_t t = (r << 32) | a[i];
+        a[i] = static_cast<std::uint32_t>(t / d);
+        r = t % d;
+    }
+    trim(a);
+    return static_cast<std::uint32_t>(r);
+}
+
+// Sets `a` to a * m + k in place.
+static void mul_add_limb(Limbs& a, std::uint32_t m, std::uint32_t k) {
+    std::uint64_t carry = k;
+    for (std::uint32_t& l : a) {
+        std::uint64_t t = std::uint64_t {l} * m + carry;
+        l = static_cast<std::uint32_t>(t);
+        carry = t >> 32;
+    }
+    if (carry) a.push_back(static_cast<std::uint32_t>(carry));
+}
+
+//
+// divmod_mag(u,v,q,r)
+//
+// Sets `q` and `r` to the quotient and remainder of u / v, for v > 0, by
+// Knuth's algorithm D (TAOCP vol. 2, 4.3.1): `v` is shifted so that its
+// top limb has its top bit set, and then each limb of the quotient is
+// estimated from the top two limbs of what is left of `u`, and is off by
+// at most two.
+//
+static void divmod_mag(const Limbs& u, const Limbs& v, Limbs& q, Limbs& r) {
+    if (compare_mag(u, v) < 0) {
+        q.clear();
+        r = u;
+        return;
+    }
+    if (v.size() == 1) {
+        q = u;
+        std::uint32_t rem = div_limb(q, v[0]);
+        r = rem ? Limbs {rem} : Limbs {};
+        return;
+    }
+    std::size_t n = v.size();
+    std::size_t m = u.size() - n;
+    int s = __builtin_clz(v.back());
+    Limbs vn(n);
+    Limbs un(u.size() + 1);
+    for (std::size_t i = n; i-- > 0; ) {
+        vn[i] = (v[i] << s) | (s && i > 0 ? v[i - 1] >> (32 - s) : 0);
+    }
+    un[u.size()] = s ? u.back() >> (32 - s) : 0;
+    for (std::size_t i = u.size(); i-- > 0; ) {
+        un[i] = (u[i] << s) | (s && i > 0 ? u[i - 1] >> (32 - s) : 0);
+    }
+    q.assign(m + 1, 0);
+    for (std::size_t j = m + 1; j-- > 0; ) {
+        std::uint64_t top = (std::uint64_t {un[j + n]} << 32) | un[j + n - 1];
+        std::uint64_t qhat = top / vn[n - 1];
+        std::uint64_t rhat = top % vn[n - 1];
+        while (qhat >= BASE || qhat * vn[n - 2] > ((rhat << 32) | un[j + n - 2])) {
+            qhat--;
+            rhat += vn[n - 1];
+            if (rhat >= BASE) break;
+        }
+        // Subtract qhat * vn from the top of un.
+        std::int64_t k = 0;
+        std::int64_t t = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            std::uint64_t p = qhat * vn[i];
+            t = std::int64_t {un[i + j]} - k - static_cast<std::int64_t>(p & 0xFFFFFFFF);
+            un[i + j] = static_cast<std::uint32_t>(t);
+            k = static_cast<std::int64_t>(p >> 32) - (t >> 32);
+        }
+        t = std::int64_t {un[j + n]} - k;
+        un[j + n] = static_cast<std::uint32_t>(t);
+        q[j] = static_cast<std::uint32_t>(qhat);
+        if (t < 0) {
+            // It was one too many: add vn back.
+            q[j]--;
+            std::uint64_t c = 0;
+            for (std::size_t i = 0; i < n; i++) {
+                std::uint64_t a = std::uint64_t {un[i + j]} + vn[i] + c;
+                un[i + j] = static_cast<std::uint32_t>(a);
+                c = a >> 32;
+            }
+            un[j + n] += static_cast<std::uint32_t>(c);
+        }
+    }
+    trim(q);
+    r.assign(n, 0);
+    for (std::size_t i = 0; i < n; i++) {
+        r[i] = (un[i] >> s) | (s ? un[i + 1] << (32 - s) : 0);
+    }
+    trim(r);
+}
+
+// * * * * *
+
+Bign::Bign(bool negative, Limbs limbs) : data {nullptr} {
+    trim(limbs);
+    if (!limbs.empty()) {
+        data = new Data {{1}, negative, std::move(limbs)};
+    }
+}
+
+Bign::Bign(long long n) : data {nullptr} {
+    unsigned long long m = n < 0 ? 0ULL - static_cast<unsigned long long>(n)
+                                 : static_cast<unsigned long long>(n);
+    if (m != 0) {
+        Limbs limbs {static_cast<std::uint32_t>(m), static_cast<std::uint32_t>(m >> 32)};
+        trim(limbs);
+        data = new Data {{1}, n < 0, std::move(limbs)};
+    }
+}
+
+const Limbs& Bign::limbs(void) const {
+    static const Limbs zero {};
+    return data ? data->limbs : zero;
+}
+
+//
+// Bign::parse(digits,negative)
+//
+// Gives the value of a string of decimal digits (and nothing else),
+// negated if `negative`. The digits are taken a chunk at a time.
+//
+Bign Bign::parse(std::string_view digits, bool negative) {
+    Limbs limbs {};
+    std::size_t first = digits.size() % CHUNK_DIGITS;
+    if (first == 0) first = CHUNK_DIGITS;
+    for (std::size_t at = 0; at < digits.size(); ) {
+        std::size_t len = at == 0 ? first : CHUNK_DIGITS;
+        std::uint32_t chunk = 0;
+        std::uint32_t scale = 1;
+        for (std::size_t i = 0; i < len; i++) {
+            chunk = chunk * 10 + static_cast<std::uint32_t>(digits[at + i] - '0');
+            scale *= 10;
+        }
+        mul_add_limb(limbs, scale, chunk);
+        at += len;
+    }
+    return Bign {negative, std::move(limbs)};
+}
+
+//
+// b.fits(n)
+//
+// Gives whether `b` fits in a `long long`, and if so sets `n` to it.
+//
+bool Bign::fits(long long& n) const {
+    const Limbs& l = limbs();
+    if (l.size() > 2) {
+        return false;
+    }
+    unsigned long long m = 0;
+    if (l.size() > 0) m = l[0];
+    if (l.size() > 1) m |= static_cast<unsigned long long>(l[1]) << 32;
+    unsigned long long most = 1ULL << 63;
+    if (negative() ? m > most : m >= most) {
+        return false;
+    }
+    n = negative() ? static_cast<long long>(0ULL - m) : static_cast<long long>(m);
+    return true;
+}
+
+//
+// b.str()
+//
+// Gives the decimal digits of `b`, a chunk at a time from the bottom.
+//
+std::string Bign::str(void) const {
+    Limbs l = limbs();
+    if (l.empty()) {
+        return "0";
+    }
+    std::vector<std::uint32_t> chunks {};
+    while (!l.empty()) {
+        chunks.push_back(div_limb(l, CHUNK));
+    }
+    std::string s = negative() ? "-" : "";
+    s += std::to_string(chunks.back());
+    for (std::size_t i = chunks.size() - 1; i-- > 0; ) {
+        std::string c = std::to_string(chunks[i]);
+        s.append(CHUNK_DIGITS - c.size(), '0');
+        s += c;
+    }
+    return s;
+}
+
+Bign operator-(const Bign& b) {
+    return Bign {!b.negative(), b.limbs()};
+}
+
+Bign operator+(const Bign& b1, const Bign& b2) {
+    if (b1.negative() == b2.negative()) {
+        return Bign {b1.negative(), add_mag(b1.limbs(), b2.limbs())};
+    } else if (compare_mag(b1.limbs(), b2.limbs()) >= 0) {
+        return Bign {b1.negative(), sub_mag(b1.limbs(), b2.limbs())};
+    } else {
+        return Bign {b2.negative(), sub_mag(b2.limbs(), b1.limbs())};
+    }
+}
+
+Bign operator-(const Bign& b1, const Bign& b2) {
+    return b1 + -b2;
+}
+
+Bign operator*(const Bign& b1, const Bign& b2) {
+    return Bign {b1.negative() != b2.negative(), mul_mag(b1.limbs(), b2.limbs())};
+}
+
+//
+// divmod(n,d,q,r)
+//
+// Sets `q` and `r` to the floor of n / d and to n - q * d, for d != 0.
+// The magnitudes are divided first, which rounds towards zero; when the
+// signs differ and there is a remainder, that is one too close.
+//
+void divmod(const Bign& n, const Bign& d, Bign& q, Bign& r) {
+    Limbs ql {};
+    Limbs rl {};
+    divmod_mag(n.limbs(), d.limbs(), ql, rl);
+    bool q_negative = n.negative() != d.negative();
+    if (q_negative && !rl.empty()) {
+        mul_add_limb(ql, 1, 1);
+        rl = sub_mag(d.limbs(), rl);
+    }
+    q = Bign {q_negative, std::move(ql)};
+    r = Bign {d.negative(), std::move(rl)};
+}
+
+int compare(const Bign& b1, const Bign& b2) {
+    if (b1.negative() != b2.negative()) {
+        return b1.negative() ? -1 : 1;
+    }
+    int c = compare_mag(b1.limbs(), b2.limbs());
+    return b1.negative() ? -c : c;
+}
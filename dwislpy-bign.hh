@@ -0,0 +1,72 @@
+#ifndef _DWISLPY_BIGN_H
+#define _DWISLPY_BIGN_H
+
+//
+// dwislpy-bign.hh
+//
+// Defines `Bign`, an integer of any size, for the DWISLPY ints that do
+// not fit in a `Word`. Those that do are held as plain `Word`s instead,
+// and most ints are, so a `Bign` is made only when an operation on them
+// overflows (see the `..._fits` functions of dwislpy-ast.hh).
+//
+// A `Bign` is a sign and a magnitude, given as 32-bit limbs, least
+// significant first, with no leading zero limbs. Like a `Strg`, it is
+// just a pointer to them, counted, so copying one never allocates. It is
+// never changed once made, and its count is kept atomically, so a `Bign`
+// literal can be shared by threads running a program at once. Zero has
+// no limbs at all.
+//
+// Its operations are those of Python's ints: `divmod` rounds the quotient
+// down (towards minus infinity), so that the remainder has the sign of
+// the divisor, which must not be zero. Multiplication is the schoolbook
+// method and division is Knuth's algorithm D, both quadratic in the
+// limbs.
+//
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <atomic>
+#include <cstdint>
+
+class Bign {
+public:
+    Bign(void) : data {nullptr} { }
+    explicit Bign(long long n);
+    Bign(const Bign& b) : data {b.data} {
+        if (data) data->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    Bign(Bign&& b) noexcept : data {b.data} {
+        b.data = nullptr;
+    }
+    Bign& operator=(Bign b) noexcept {
+        std::swap(data, b.data);
+        return *this;
+    }
+    ~Bign(void) {
+        if (data && data->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) delete data;
+    }
+    static Bign parse(std::string_view digits, bool negative);
+    bool fits(long long& n) const;
+    bool negative(void) const { return data && data->negative; }
+    std::string str(void) const;
+    friend Bign operator-(const Bign& b);
+    friend Bign operator+(const Bign& b1, const Bign& b2);
+    friend Bign operator-(const Bign& b1, const Bign& b2);
+    friend Bign operator*(const Bign& b1, const Bign& b2);
+    friend void divmod(const Bign& n, const Bign& d, Bign& q, Bign& r);
+    friend int compare(const Bign& b1, const Bign& b2);
+private:
+    typedef std::vector<std::uint32_t> Limbs;
+    struct Data {
+        std::atomic<unsigned int> refs;
+        bool negative;
+        Limbs limbs;
+    };
+    Data* data;
+    Bign(bool negative, Limbs limbs);
+    const Limbs& limbs(void) const;
+};
+
+#endif
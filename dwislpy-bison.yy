@@ -1,7 +1,9 @@
 %skeleton "lalr1.cc"
 %require  "3.0"
-%debug 
 %defines 
+// No `%debug`: the parser's tracing is only compiled in when YYDEBUG is
+// defined as 1 (see PARSE_TRACE in the Makefile), as it costs a little
+// for every token otherwise.
 %define api.namespace {DWISLPY}
 %define api.parser.class {Parser}
 %define parse.error verbose
@@ -85,11 +87,10 @@
 %token               FALS "False"
 %token               REPT "repeat"
 %token               UNTL "until"
-%token <int>         NMBR
-%token <std::string> NAME
+%token <Valu>        NMBR
+%token <std::string_view> NAME
 %token <std::string> STRG
 
-%type <Prgm_ptr> prgm
 %type <Defs>     defs
 %type <Defn_ptr> defn
 %type <Blck_ptr> nest
@@ -97,6 +98,7 @@
 %type <Fmag>     fmag
 %type <Args_vec> expns
 %type <Stmt_vec> stms
+%type <Stmt_vec> scpt
 %type <Stmt_ptr> stmt
 %type <Expn_ptr> expn
 %type <Ifcd_vec> elifb
@@ -114,35 +116,42 @@
 %left CMEQ CMLE CMGE CMLT CMGT;
 %left PLUS MNUS;
 %left TMES IMOD IDIV;
+%precedence UMNS; // Negation binds tighter than * and //, as in Python.
 
+// The program is handed to the driver as soon as its definitions are
+// parsed, and then each statement of its main script is too, so that
+// a streamed script (see Driver::stream) can be run as it is parsed.
 main:
-  prgm {
-      main.set($1);
+  defs {
+      main.set(Prgm_ptr { new Prgm {std::move($1), Blck_ptr{nullptr}, lexer.locate(@1)} });
+  } scpt {
+      if (!$3.empty()) {
+          Locn lo = $3[0]->where();
+          main.set(Blck_ptr { new Blck {std::move($3), lo} });
+      }
   }
 ;
 
-prgm:
-  defs blck {
-      Defs ds = $1; 
-      Blck_ptr b = $2;
-
-      $$ = Prgm_ptr { new Prgm {ds, b, lexer.locate(@1)} };
+scpt:
+  scpt stmt {
+      $$ = std::move($1);
+      if (!main.step($2)) {
+          $$.push_back($2);
+      }
   }
-| defs {
-      $$ = Prgm_ptr { new Prgm {$1, Blck_ptr{nullptr}, lexer.locate(@1)} };
+| {
+      $$ = Stmt_vec {};
   }
 ;
 
 defs:
     defs defn {
-        Defs ds = $1;
-        ds[$2->name] = $2;
-        $$ = ds;
+        $$ = std::move($1);
+        $$[$2->name] = $2;
     }
 |   defn {
-        Defs ds {};
-        ds[$1->name] = $1;
-        $$ = ds;
+        $$ = Defs {};
+        $$[$1->name] = $1;
     }
 |   {
         $$ = Defs {};
@@ -166,17 +175,17 @@ type:
 
 fmag:
    fmag COMA NAME COLN type {
-       $$ = $1;
-       $$.add_frml($3, $5);
+       $$ = std::move($1);
+       $$.add_frml(Name {$3}, $5);
    }
 |  NAME COLN type {
        $$ = Fmag {};
-       $$.add_frml($1, $3);
+       $$.add_frml(Name {$1}, $3);
     }
 
 defn: 
     DEFF NAME LPAR fmag RPAR ARRW type COLN EOLN nest {
-        $$ = Defn_ptr { new Defn { $2, $4, $10, $7, $10->where() } };
+        $$ = Defn_ptr { new Defn { Name {$2}, std::move($4), $10, $7, $10->where() } };
     }
 ;
 
@@ -191,51 +200,50 @@ nest:
 
 blck:
   stms {
-      Stmt_vec ss = $1;
-      $$ = Blck_ptr { new Blck {ss, ss[0]->where()} };
+      Locn lo = $1[0]->where();
+      $$ = Blck_ptr { new Blck {std::move($1), lo} };
   }
 ;
 
 stms:
   stms stmt {
-      Stmt_vec ss = $1;
-      ss.push_back($2);
-      $$ = ss;
+      // Moved rather than copied, so that a long block is built in linear time.
+      $$ = std::move($1);
+      $$.push_back($2);
   }
 | stmt {
-      Stmt_vec ss { };
-      ss.push_back($1);
-      $$ = ss;
+      $$ = Stmt_vec {};
+      $$.push_back($1);
   }
 ;
   
 stmt: 
   NAME LPAR expns RPAR EOLN {
-    $$ = PCll_ptr { new PCll {$1, $3, lexer.locate(@1)} };
+    $$ = PCll_ptr { new PCll {Name {$1}, std::move($3), lexer.locate(@1)} };
   }
 | REPT COLN EOLN nest UNTL expn EOLN {
     $$ = Rept_ptr { new Rept { $6, $4, lexer.locate(@1) } };
   }
 
 | NAME COLN type ASGN expn EOLN {
-      $$ = Ntro_ptr { new Ntro {$1,$3,$5,lexer.locate(@2)} };
+      $$ = Ntro_ptr { new Ntro {Name {$1}, $3, $5, lexer.locate(@2)} };
 }
 
 | NAME ASGN expn EOLN {
-      $$ = Asgn_ptr { new Asgn {$1, $3,lexer.locate(@2)} };
+      $$ = Asgn_ptr { new Asgn {Name {$1}, $3, lexer.locate(@2)} };
   }
 
 | NAME PLEQ expn EOLN {
-      $$ = Pleq_ptr { new Pleq {$1, $3, lexer.locate(@2)} };
+      $$ = Pleq_ptr { new Pleq {Name {$1}, $3, lexer.locate(@2)} };
   }
 
 | NAME MNEQ expn EOLN {
-      $$ = Mneq_ptr { new Mneq {$1, $3, lexer.locate(@2)} };
+      $$ = Mneq_ptr { new Mneq {Name {$1}, $3, lexer.locate(@2)} };
   }
 
 | IFCD expn COLN EOLN nest elifb elseb {
       $6.push_back(Ifcd_ptr {new Ifcd {$2, $5, $2->where()}});
-      $$ = Cond_ptr { new Cond {$6, $7, lexer.locate(@1)} };
+      $$ = Cond_ptr { new Cond {std::move($6), $7, lexer.locate(@1)} };
   }
 
 | WHIL expn COLN EOLN nest {
@@ -254,14 +262,14 @@ stmt:
       $$ = Pass_ptr { new Pass {lexer.locate(@1)} };
   }
 | PRNT LPAR expns RPAR EOLN {
-      $$ = Prnt_ptr { new Prnt {$3, lexer.locate(@1)} };
+      $$ = Prnt_ptr { new Prnt {std::move($3), lexer.locate(@1)} };
   }
 ;
 
 elifb: 
     elifb ELIF expn COLN EOLN nest {
         $1.push_back(Ifcd_ptr {new Ifcd {$3, $6, $3->where()}});
-        $$ = $1;   
+        $$ = std::move($1);
     }
 |   {
         $$ = Ifcd_vec {};
@@ -280,7 +288,7 @@ elseb:
 expns:
     expns COMA expn {
         $1.push_back($3);
-        $$ = $1;
+        $$ = std::move($1);
     }
 |   expn {
         $$ = Expn_vec {$1};
@@ -292,7 +300,7 @@ expns:
 
 expn:
   NAME LPAR expns RPAR {
-    $$ = FCll_ptr { new FCll { $1, $3, lexer.locate(@2) } };
+    $$ = FCll_ptr { new FCll { Name {$1}, std::move($3), lexer.locate(@2) } };
   }
 
 | expn IFCD expn ELSE expn {
@@ -305,7 +313,7 @@ expn:
 | expn MNUS expn {
       $$ = Mnus_ptr { new Mnus {$1,$3,lexer.locate(@2)} };
   }
-| MNUS expn {
+| MNUS expn %prec UMNS {
       $$ = Imus_ptr { new Imus {$2, lexer.locate(@1)} };
   }
 | expn TMES expn {
@@ -343,10 +351,10 @@ expn:
   }
 
 | NMBR {
-      $$ = Ltrl_ptr { new Ltrl {Valu {$1},lexer.locate(@1)} };
+      $$ = Ltrl_ptr { new Ltrl {std::move($1),lexer.locate(@1)} };
   }
 | STRG {
-      $$ = Ltrl_ptr { new Ltrl {Valu {de_escape($1)},lexer.locate(@1)} };
+      $$ = Ltrl_ptr { new Ltrl {Valu {de_escape(std::move($1))},lexer.locate(@1)} };
   }
 | TRUE {
       $$ = Ltrl_ptr { new Ltrl {Valu {true},lexer.locate(@1)} };
@@ -367,7 +375,7 @@ expn:
       $$ = StrC_ptr { new StrC {$3,lexer.locate(@1)} };
   }
 | NAME {
-      $$ = Lkup_ptr { new Lkup {$1,lexer.locate(@1)} };
+      $$ = Lkup_ptr { new Lkup {Name {$1},lexer.locate(@1)} };
   }
 | LPAR expn RPAR {
       $$ = $2;
@@ -0,0 +1,376 @@
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <cerrno>
+#include <filesystem>
+#include <functional>
+#include <thread>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+
+#include "dwislpy-cache.hh"
+#include "dwislpy-vm.hh"
+#include "dwislpy-util.hh"
+
+//
+// dwislpy-cache.cc
+//
+// Saving and loading compiled programs. See the header (.hh) file for
+// details.
+//
+// A cache file holds, in order (all numbers in the byte order of the
+// machine, which the format is not meant to leave):
+//
+//   "DWBC", CACHE_FORMAT, the options (see `cache_options`), the whole
+//   source text, then the hash of the payload, which is all that follows:
+//   the code      - each instruction as its opcode and argument
+//   the literals  - each as a tag (its index in `Valu`) then its value
+//   the locations - each as whether it has a file, its line, its column
+//   the funcs     - each as its name, arity, size, temps, entry, and locn
+//   the entry, size, and temps of the main script
+//
+
+static std::uint64_t fnv1a(std::uint64_t h, std::string_view s) {
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+static const std::uint64_t FNV_BASIS = 14695981039346656037ull;
+
+std::string cache_options(int level) {
+    return "-O" + (level < 0 ? std::string {"none"} : std::to_string(level));
+}
+
+std::string cache_path(const std::string& dir, std::string_view text,
+                       std::string_view options) {
+    static const char* digits = "0123456789abcdef";
+    std::uint64_t h = FNV_BASIS;
+    h = fnv1a(h, CACHE_FORMAT);
+    h = fnv1a(h, options);
+    h = fnv1a(h, text);
+    std::string name(16, '0');
+    for (int i = 15; i >= 0; i--) {
+        name[i] = digits[h & 0xf];
+        h >>= 4;
+    }
+    return dir + "/" + name + ".dwbc";
+}
+
+std::string cache_home(void) {
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+        return std::string {xdg} + "/dwislpy";
+    }
+    if (const char* home = std::getenv("HOME"); home && *home) {
+        return std::string {home} + "/.cache/dwislpy";
+    }
+    return "";
+}
+
+// * * * * *
+//
+// Writing a cache file.
+//
+
+class Wrtr {
+public:
+    std::string bytes;
+    template <typename T>
+    void put(T x) {
+        bytes.append(reinterpret_cast<const char*>(&x), sizeof(T));
+    }
+    void put_text(std::string_view s) {
+        put<std::uint64_t>(s.size());
+        bytes.append(s.data(), s.size());
+    }
+};
+
+static void put_header(Wrtr& w, std::string_view text, std::string_view options) {
+    w.bytes.append("DWBC");
+    w.put_text(CACHE_FORMAT);
+    w.put_text(options);
+    w.put_text(text);
+}
+
+void save_bytc(const std::string& path, std::string_view text,
+               std::string_view options, const Bytc& bc) {
+    Wrtr w {};
+    w.put<std::uint64_t>(bc.code.size());
+    for (const Inst& in : bc.code) {
+        w.put<std::uint8_t>(in.op);
+        w.put<std::int32_t>(in.arg);
+    }
+    w.put<std::uint64_t>(bc.ltrls.size());
+    for (const Valu& vl : bc.ltrls) {
+        w.put<std::uint8_t>(vl.index());
+        if (std::holds_alternative<Word>(vl)) {
+            w.put<std::int64_t>(std::get<Word>(vl));
+        } else if (std::holds_alternative<bool>(vl)) {
+            w.put<std::uint8_t>(std::get<bool>(vl));
+        } else if (std::holds_alternative<Strg>(vl)) {
+            w.put_text(std::get<Strg>(vl).str());
+        } else if (std::holds_alternative<Bign>(vl)) {
+            w.put_text(std::get<Bign>(vl).str());
+        }
+    }
+    w.put<std::uint64_t>(bc.locns.size());
+    for (Locn lo : bc.locns) {
+        w.put<std::uint8_t>(!lo.source_name().empty());
+        w.put<std::int32_t>(lo.line());
+        w.put<std::int32_t>(lo.column());
+    }
+    w.put<std::uint64_t>(bc.funcs.size());
+    for (const Func& fn : bc.funcs) {
+        w.put_text(fn.name);
+        w.put<std::uint32_t>(fn.arity);
+        w.put<std::uint32_t>(fn.size);
+        w.put<std::uint32_t>(fn.temps);
+        w.put<std::uint64_t>(fn.entry);
+        w.put<std::int32_t>(fn.locn);
+    }
+    w.put<std::uint64_t>(bc.entry);
+    w.put<std::uint32_t>(bc.size);
+    w.put<std::uint32_t>(bc.temps);
+    Wrtr file {};
+    put_header(file, text, options);
+    file.put<std::uint64_t>(fnv1a(FNV_BASIS, w.bytes));
+    file.bytes.append(w.bytes);
+
+    //
+    // Write to a file of our own, then move it into place, so that a run
+    // of the same program at the same time (whether by another process,
+    // or by another thread under --batch) never sees half a file.
+    //
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path {path}.parent_path(), ec);
+    std::size_t thread = std::hash<std::thread::id> {}(std::this_thread::get_id());
+    std::string temp = path + "." + std::to_string(getpid()) + "-" + std::to_string(thread) + ".tmp";
+    int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return;
+    }
+    const char* at = file.bytes.data();
+    std::size_t left = file.bytes.size();
+    while (left > 0) {
+        ssize_t n = write(fd, at, left);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) break;
+        at += n;
+        left -= n;
+    }
+    close(fd);
+    if (left > 0 || std::rename(temp.c_str(), path.c_str()) != 0) {
+        unlink(temp.c_str());
+    }
+}
+
+// * * * * *
+//
+// Reading a cache file.
+//
+// Each `get` checks that there is enough of the file left, and any
+// failure just marks the whole read as bad.
+//
+
+class Rder {
+public:
+    Rder(const char* p, std::size_t n) : at {p}, end {p + n} { }
+    bool ok = true;
+    template <typename T>
+    T get(void) {
+        T x {};
+        if (static_cast<std::size_t>(end - at) < sizeof(T)) {
+            ok = false;
+            return x;
+        }
+        std::memcpy(&x, at, sizeof(T));
+        at += sizeof(T);
+        return x;
+    }
+    std::string_view get_text(void) {
+        std::uint64_t n = get<std::uint64_t>();
+        if (!ok || static_cast<std::uint64_t>(end - at) < n) {
+            ok = false;
+            return {};
+        }
+        std::string_view s {at, static_cast<std::size_t>(n)};
+        at += n;
+        return s;
+    }
+    bool expect(std::string_view s) {
+        if (static_cast<std::size_t>(end - at) < s.size()
+            || std::memcmp(at, s.data(), s.size()) != 0) {
+            ok = false;
+            return false;
+        }
+        at += s.size();
+        return true;
+    }
+    // rest() - all of the file that is left
+    std::string_view rest(void) const {
+        return std::string_view {at, static_cast<std::size_t>(end - at)};
+    }
+    // count(each) - a count of items, each at least `each` bytes long
+    std::size_t count(std::size_t each) {
+        std::uint64_t n = get<std::uint64_t>();
+        if (!ok || n > static_cast<std::uint64_t>(end - at) / each) {
+            ok = false;
+            return 0;
+        }
+        return static_cast<std::size_t>(n);
+    }
+private:
+    const char* at;
+    const char* end;
+};
+
+//
+// valid_code(bc)
+//
+// Whether the argument of each instruction of `bc` is in range for what
+// it indexes, so that no damaged file can have the machine reach outside
+// of the code, its tables, or the frame. Each body's code runs from its
+// entry to the next one's, and the main script's, which comes last,
+// ends with a HALT, so that the machine never runs off the end.
+//
+static bool valid_code(const Bytc& bc) {
+    if (bc.code.empty() || bc.code.back().op != HALT || bc.entry >= bc.code.size()) {
+        return false;
+    }
+    std::vector<std::pair<std::size_t,unsigned int>> bodies {{bc.entry, bc.size}};
+    for (const Func& f : bc.funcs) {
+        if (f.entry >= bc.code.size() || f.arity > f.size) return false;
+        bodies.emplace_back(f.entry, f.size);
+    }
+    std::sort(bodies.begin(), bodies.end());
+    if (bodies[0].first != 0) {
+        return false;
+    }
+    std::size_t b = 0;
+    for (std::size_t pc = 0; pc < bc.code.size(); pc++) {
+        while (b + 1 < bodies.size() && bodies[b + 1].first <= pc) {
+            b++;
+        }
+        const Inst& in = bc.code[pc];
+        if (in.arg < 0) {
+            return false;
+        }
+        std::size_t arg = static_cast<std::size_t>(in.arg);
+        std::size_t bound = 1; // What `arg` must be below: 0, unless it indexes.
+        switch (in.op) {
+        case LTRL:
+            bound = bc.ltrls.size();
+            break;
+        case LOAD: case STOR: case PLEQ: case MNEQ:
+            bound = bodies[b].second;
+            break;
+        case PLUS: case MNUS: case TMES: case IDIV: case IMOD: case INPT: case INTC:
+            bound = bc.locns.size();
+            break;
+        case JUMP: case JMPF:
+            bound = bc.code.size();
+            break;
+        case CALL: case TAIL:
+            bound = bc.funcs.size();
+            break;
+        default:
+            break;
+        }
+        if (arg >= bound) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool read_bytc(Rder& r, std::string_view text, std::string_view options,
+                      const std::string& fn, Bytc& bc) {
+    if (!r.expect("DWBC")
+        || r.get_text() != CACHE_FORMAT
+        || r.get_text() != options
+        || r.get_text() != text
+        || !r.ok) {
+        return false;
+    }
+    std::uint64_t payload = r.get<std::uint64_t>();
+    if (!r.ok || fnv1a(FNV_BASIS, r.rest()) != payload) {
+        return false;
+    }
+    std::size_t n = r.count(5);
+    bc.code.reserve(n);
+    for (std::size_t i = 0; i < n && r.ok; i++) {
+        std::uint8_t op = r.get<std::uint8_t>();
+        if (op > HALT) return false;
+        bc.code.push_back(Inst {static_cast<Opcd>(op), r.get<std::int32_t>()});
+    }
+    n = r.count(1);
+    for (std::size_t i = 0; i < n && r.ok; i++) {
+        switch (r.get<std::uint8_t>()) {
+        case 0: bc.ltrl(Valu {Word {r.get<std::int64_t>()}}); break;
+        case 1: bc.ltrl(Valu {r.get<std::uint8_t>() != 0}); break;
+        case 2: bc.ltrl(Valu {Strg {std::string {r.get_text()}}}); break;
+        case 3: bc.ltrl(Valu {None}); break;
+        case 4: {
+            Valu v {};
+            if (!parse_int(r.get_text(), v)) return false;
+            bc.ltrl(std::move(v));
+            break;
+        }
+        default: return false;
+        }
+    }
+    n = r.count(9);
+    for (std::size_t i = 0; i < n && r.ok; i++) {
+        bool has_file = r.get<std::uint8_t>();
+        int line = r.get<std::int32_t>();
+        int column = r.get<std::int32_t>();
+        bc.locn(has_file ? Locn {fn, line, column} : Locn {});
+    }
+    n = r.count(32);
+    for (std::size_t i = 0; i < n && r.ok; i++) {
+        Func f {};
+        f.name = std::string {r.get_text()};
+        f.arity = r.get<std::uint32_t>();
+        f.size = r.get<std::uint32_t>();
+        f.temps = r.get<std::uint32_t>();
+        f.entry = r.get<std::uint64_t>();
+        f.locn = r.get<std::int32_t>();
+        if (f.locn < 0 || static_cast<std::size_t>(f.locn) >= bc.locns.size()) return false;
+        bc.dclr(f);
+    }
+    bc.entry = r.get<std::uint64_t>();
+    bc.size = r.get<std::uint32_t>();
+    bc.temps = r.get<std::uint32_t>();
+    return r.ok && valid_code(bc);
+}
+
+bool load_bytc(const std::string& path, std::string_view text,
+               std::string_view options, const std::string& fn, Bytc& bc) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        return false;
+    }
+    Rder r {static_cast<const char*>(p), static_cast<std::size_t>(st.st_size)};
+    bool ok = read_bytc(r, text, options, fn, bc);
+    munmap(p, st.st_size);
+    return ok;
+}
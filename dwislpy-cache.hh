@@ -0,0 +1,56 @@
+#ifndef _DWISLPY_CACHE_H
+#define _DWISLPY_CACHE_H
+
+//
+// dwislpy-cache.hh
+//
+// Defines the cache of compiled programs used by `--vm`. Lexing, parsing,
+// checking, and optimizing a program gives the same `Bytc` every time
+// for the same source, so the first run saves that `Bytc` in a file,
+// and later runs of the same source map that file back in and go
+// straight to running it on the machine.
+//
+// A cache file is named after a hash of the source text, the options
+// the compiled code depends on, and `CACHE_FORMAT`, which must be
+// changed whenever the compiler or the layout of a `Bytc` changes in a
+// way that makes old files wrong. The file starts with all of these,
+// the whole of the source text included, and loading compares them
+// with those of the run, so two sources whose names collide only ever
+// miss. It also checks a hash of the rest of the file, and the
+// argument of every instruction is checked to be in range for what it
+// indexes (see `valid_code`). So a file that doesn't match, or is cut
+// short or otherwise damaged, is just a miss.
+//
+// The location table of a `Bytc` is saved as lines and columns only.
+// Loading rebuilds it with the name of the source file being run, so
+// that errors report that file even when the same text was cached
+// under another name.
+//
+//   cache_options - the text of the options the compiled code depends
+//                 on, which is only the -O level, as given (no -O is
+//                 kept apart from -O0 and -O1, even where their code
+//                 is the same)
+//   cache_path  - the cache file for a source text and options
+//   load_bytc   - read a cache file into an empty `Bytc`, giving
+//                 whether that worked
+//   save_bytc   - write a cache file (best effort: failures are ignored)
+//   cache_home  - the default directory for the cache, which is
+//                 $XDG_CACHE_HOME/dwislpy or else ~/.cache/dwislpy
+//
+
+#include <string>
+#include <string_view>
+#include "dwislpy-vm.hh"
+
+constexpr const char* CACHE_FORMAT = "dwislpy-bytc-5";
+
+std::string cache_options(int level);
+std::string cache_path(const std::string& dir, std::string_view text,
+                       std::string_view options);
+bool load_bytc(const std::string& path, std::string_view text,
+               std::string_view options, const std::string& fn, Bytc& bc);
+void save_bytc(const std::string& path, std::string_view text,
+               std::string_view options, const Bytc& bc);
+std::string cache_home(void);
+
+#endif
@@ -0,0 +1,570 @@
+#include <string>
+#include <vector>
+#include <map>
+#include <sstream>
+#include <iostream>
+
+#include "dwislpy-cgen.hh"
+#include "dwislpy-ast.hh"
+#include "dwislpy-check.hh"
+#include "dwislpy-util.hh"
+
+//
+// dwislpy-cgen.cc
+//
+// Below are the implementations of the methods of `Cgen` followed by
+// those of the `cgen` and `cexp` methods of the AST nodes. See the
+// header (.hh) for an overview of the translation into C.
+//
+
+//
+// c_quote(s)
+//
+// Gives the C string literal for the characters of `s`.
+//
+static std::string c_quote(const std::string& s) {
+    std::stringstream ss {};
+    ss << '"';
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') {
+            ss << '\\' << c;
+        } else if (c == '\n') {
+            ss << "\\n";
+        } else if (c == '\t') {
+            ss << "\\t";
+        } else if (c < ' ' || c >= 127) {
+            // Three octal digits, so that no following digit is taken in.
+            ss << '\\' << char('0' + (c >> 6)) << char('0' + ((c >> 3) & 7)) << char('0' + (c & 7));
+        } else {
+            ss << c;
+        }
+    }
+    ss << '"';
+    return ss.str();
+}
+
+std::string c_type(Type type) {
+    return is_str(type) ? "dw_str*" : "dw_int";
+}
+
+// * * * * *
+//
+// Cgen
+//
+
+std::ostream& Cgen::line(void) {
+    code << indent;
+    return code;
+}
+
+void Cgen::open(void) {
+    indent += "    ";
+}
+
+void Cgen::close(void) {
+    indent.resize(indent.size() - 4);
+}
+
+std::string Cgen::temp(void) {
+    return "t" + std::to_string(temps++);
+}
+
+std::string Cgen::ltrl(const Strg& s) {
+    auto found = ltrl_ids.find(s.str());
+    if (found != ltrl_ids.end()) {
+        return "k" + std::to_string(found->second);
+    }
+    int id = ltrls.size();
+    ltrls.push_back(s.str());
+    ltrl_ids[s.str()] = id;
+    return "k" + std::to_string(id);
+}
+
+std::string Cgen::where(Locn lo) const {
+    // Drop the space that separates it from the message.
+    std::string prefix = dwislpy_message(lo, "");
+    prefix.pop_back();
+    return c_quote(prefix);
+}
+
+std::string Cgen::var(int slot) const {
+    return "v" + std::to_string(slot) + "_" + frame->get_slot(slot)->name;
+}
+
+void Cgen::drops(void) {
+    for (unsigned int i = 0; i < frame->get_size(); i++) {
+        if (is_str(frame->get_slot(i)->type)) {
+            line() << "dw_drop(" << var(i) << ");" << std::endl;
+        }
+    }
+}
+
+void Cgen::output(std::ostream& os) const {
+    os << "/* Generated by dwislpy --emit-c. */" << std::endl;
+    os << "#include \"dwislpy-rt.h\"" << std::endl;
+    os << std::endl;
+    for (std::size_t i = 0; i < ltrls.size(); i++) {
+        os << "static dw_str k" << i << " = DW_LTRL(" << c_quote(ltrls[i]) << ");" << std::endl;
+    }
+    os << std::endl;
+    os << code.str();
+}
+
+// * * * * *
+//
+// Prgm::cgen, Defn::cgen, Blck::cgen
+//
+
+//
+// dclr_vars(cg,from)
+//
+// Declares the C variables for the slots of the current frame, starting
+// with slot `from`, each initialized as an empty value of its type.
+//
+static void dclr_vars(Cgen& cg, unsigned int from) {
+    for (unsigned int i = from; i < cg.frame->get_size(); i++) {
+        Type ty = cg.frame->get_slot(i)->type;
+        cg.line() << c_type(ty) << " " << cg.var(i) << " = "
+                  << (is_str(ty) ? "&dw_empty" : "0") << ";" << std::endl;
+    }
+}
+
+static std::string c_proto(const Defn& defn) {
+    std::stringstream ss {};
+    ss << "static " << c_type(defn.ret_type) << " f_" << defn.name << "(";
+    unsigned int arity = defn.args.get_frmls_size();
+    for (unsigned int i = 0; i < arity; i++) {
+        const SymInfo* fm = defn.args.get_frml(i);
+        if (i > 0) ss << ", ";
+        ss << c_type(fm->type) << " v" << fm->identifier << "_" << fm->name;
+    }
+    if (arity == 0) ss << "void";
+    ss << ")";
+    return ss.str();
+}
+
+void Prgm::cgen(Cgen& cg) const {
+    // In order of their names, so that the output is always the same.
+    std::map<Name,Defn_ptr> sorted {defs.begin(), defs.end()};
+    cg.defs = &defs;
+    for (auto [name, defn] : sorted) {
+        cg.line() << c_proto(*defn) << ";" << std::endl;
+    }
+    cg.line() << std::endl;
+    for (auto [name, defn] : sorted) {
+        defn->cgen(cg);
+    }
+    cg.line() << "int main(void) {" << std::endl;
+    cg.open();
+    cg.frame = &main_symt;
+    cg.in_main = true;
+    dclr_vars(cg, 0);
+    main->cgen(cg);
+    cg.line() << "return 0;" << std::endl;
+    cg.close();
+    cg.line() << "}" << std::endl;
+}
+
+void Defn::cgen(Cgen& cg) const {
+    cg.line() << c_proto(*this) << " {" << std::endl;
+    cg.open();
+    cg.frame = &args;
+    cg.in_main = false;
+    dclr_vars(cg, args.get_frmls_size());
+    body->cgen(cg);
+    // Not reached, since checked bodies always return.
+    cg.drops();
+    cg.line() << "return " << (is_str(ret_type) ? "&dw_empty" : "0") << ";" << std::endl;
+    cg.close();
+    cg.line() << "}" << std::endl;
+    cg.line() << std::endl;
+}
+
+void Blck::cgen(Cgen& cg) const {
+    for (Stmt_ptr s : stmts) {
+        s->cgen(cg);
+    }
+}
+
+// * * * * *
+//
+// Stmt::cgen
+//
+
+void Asgn::cgen(Cgen& cg) const {
+    std::string e = expn->cexp(cg);
+    if (is_str(expn->type)) {
+        cg.line() << "dw_set(&" << cg.var(slot) << ", " << e << ");" << std::endl;
+    } else {
+        cg.line() << cg.var(slot) << " = " << e << ";" << std::endl;
+    }
+}
+
+void Ntro::cgen(Cgen& cg) const {
+    std::string e = expn->cexp(cg);
+    if (is_str(type)) {
+        cg.line() << "dw_set(&" << cg.var(slot) << ", " << e << ");" << std::endl;
+    } else {
+        cg.line() << cg.var(slot) << " = " << e << ";" << std::endl;
+    }
+}
+
+void Pleq::cgen(Cgen& cg) const {
+    std::string e = expn->cexp(cg);
+    if (is_str(expn->type)) {
+        cg.line() << "dw_append(&" << cg.var(slot) << ", " << e << ");" << std::endl;
+    } else {
+        cg.line() << cg.var(slot) << " = dw_add(" << cg.var(slot) << ", " << e << ", "
+                  << cg.where(where()) << ");" << std::endl;
+    }
+}
+
+void Mneq::cgen(Cgen& cg) const {
+    std::string e = expn->cexp(cg);
+    cg.line() << cg.var(slot) << " = dw_sub(" << cg.var(slot) << ", " << e << ", "
+              << cg.where(where()) << ");" << std::endl;
+}
+
+void Cond::cgen(Cgen& cg) const {
+    //
+    // Each test after the first goes within the `else` of the one before,
+    // since computing its condition might take some statements.
+    //
+    for (Ifcd_ptr ifcd : ifcds) {
+        std::string c = ifcd->cond->cexp(cg);
+        cg.line() << "if (" << c << ") {" << std::endl;
+        cg.open();
+        ifcd->body->cgen(cg);
+        cg.close();
+        cg.line() << "} else {" << std::endl;
+        cg.open();
+    }
+    if (els) {
+        els->cgen(cg);
+    }
+    for (std::size_t i = 0; i < ifcds.size(); i++) {
+        cg.close();
+        cg.line() << "}" << std::endl;
+    }
+}
+
+void Ifcd::cgen([[maybe_unused]] Cgen& cg) const {
+    throw DwislpyError(where(), "should not be called directly");
+}
+
+void Elif::cgen([[maybe_unused]] Cgen& cg) const {
+    throw DwislpyError(where(), "should not be called directly");
+}
+
+void Else::cgen(Cgen& cg) const {
+    body->cgen(cg);
+}
+
+void Whil::cgen(Cgen& cg) const {
+    cg.line() << "for (;;) {" << std::endl;
+    cg.open();
+    std::string c = cond->cexp(cg);
+    cg.line() << "if (!" << c << ") break;" << std::endl;
+    body->cgen(cg);
+    cg.close();
+    cg.line() << "}" << std::endl;
+}
+
+void Rept::cgen(Cgen& cg) const {
+    cg.line() << "for (;;) {" << std::endl;
+    cg.open();
+    body->cgen(cg);
+    std::string c = cond->cexp(cg);
+    cg.line() << "if (" << c << ") break;" << std::endl;
+    cg.close();
+    cg.line() << "}" << std::endl;
+}
+
+void FRtn::cgen(Cgen& cg) const {
+    std::string e = expn->cexp(cg);
+    if (cg.in_main) {
+        // A return from the main script just ends it.
+        if (is_str(expn->type)) {
+            cg.line() << "dw_drop(" << e << ");" << std::endl;
+        }
+        cg.line() << "return 0;" << std::endl;
+        return;
+    }
+    std::string t = cg.temp();
+    cg.line() << c_type(expn->type) << " " << t << " = " << e << ";" << std::endl;
+    cg.drops();
+    cg.line() << "return " << t << ";" << std::endl;
+}
+
+void PRtn::cgen(Cgen& cg) const {
+    if (!cg.in_main) {
+        cg.drops();
+    }
+    cg.line() << "return 0;" << std::endl;
+}
+
+void Prnt::cgen(Cgen& cg) const {
+    for (std::size_t i = 0; i < expns.size(); i++) {
+        if (i > 0) {
+            cg.line() << "dw_print_space();" << std::endl;
+        }
+        Expn_ptr e = expns[i];
+        std::string v = e->cexp(cg);
+        if (is_str(e->type)) {
+            std::string t = cg.temp();
+            cg.line() << "dw_str* " << t << " = " << v << ";" << std::endl;
+            cg.line() << "dw_print_str(" << t << ");" << std::endl;
+            cg.line() << "dw_drop(" << t << ");" << std::endl;
+        } else if (is_int(e->type)) {
+            cg.line() << "dw_print_int(" << v << ");" << std::endl;
+        } else if (is_bool(e->type)) {
+            cg.line() << "dw_print_bool(" << v << ");" << std::endl;
+        } else {
+            cg.line() << "(void)" << v << ";" << std::endl;
+            cg.line() << "dw_print_none();" << std::endl;
+        }
+    }
+    cg.line() << "dw_print_end();" << std::endl;
+}
+
+void Pass::cgen([[maybe_unused]] Cgen& cg) const {
+    // Nothing to do.
+}
+
+//
+// c_call(cg,name,args)
+//
+// Gives the C call of definition `name`, computing its arguments first.
+//
+static std::string c_call(Cgen& cg, const Name& name, const Expn_vec& args) {
+    std::vector<std::string> vs {};
+    for (Expn_ptr a : args) {
+        vs.push_back(a->cexp(cg));
+    }
+    std::string call = "f_" + name + "(";
+    for (std::size_t i = 0; i < vs.size(); i++) {
+        if (i > 0) call += ", ";
+        call += vs[i];
+    }
+    return call + ")";
+}
+
+void PCll::cgen(Cgen& cg) const {
+    std::string call = c_call(cg, name, args);
+    if (is_str(cg.defs->at(name)->ret_type)) {
+        cg.line() << "dw_drop(" << call << ");" << std::endl;
+    } else {
+        cg.line() << "(void)" << call << ";" << std::endl;
+    }
+}
+
+void Expn::cgen(Cgen& cg) const {
+    std::string e = cexp(cg);
+    if (is_str(type)) {
+        cg.line() << "dw_drop(" << e << ");" << std::endl;
+    } else {
+        cg.line() << "(void)" << e << ";" << std::endl;
+    }
+}
+
+// * * * * *
+//
+// Expn::cexp
+//
+
+//
+// hoist(cg,type,e)
+//
+// Computes `e` into a new temporary at this point, giving its name.
+//
+static std::string hoist(Cgen& cg, Type type, std::string e) {
+    std::string t = cg.temp();
+    cg.line() << c_type(type) << " " << t << " = " << e << ";" << std::endl;
+    return t;
+}
+
+std::string Ltrl::cexp(Cgen& cg) const {
+    if (holds_int(valu)) {
+        // The C ints are only those of a `Word` (see dwislpy-rt.h), as
+        // well as WIDE, which the interpreter keeps as a `Bign`.
+        Word n = 0;
+        if (const Word* w = std::get_if<Word>(&valu)) {
+            n = *w;
+        } else if (!std::get<Bign>(valu).fits(n)) {
+            throw DwislpyError { where(), "Too big an int for C: " + to_string(valu) + "." };
+        }
+        if (n == WIDE) {
+            // Its digits without the sign are too big for a C literal.
+            return "(-" + std::to_string(-(n + 1)) + "LL - 1)";
+        }
+        return "(" + std::to_string(n) + "LL)";
+    } else if (std::holds_alternative<bool>(valu)) {
+        return std::get<bool>(valu) ? "1" : "0";
+    } else if (std::holds_alternative<Strg>(valu)) {
+        return "&" + cg.ltrl(std::get<Strg>(valu));
+    } else {
+        return "0";
+    }
+}
+
+std::string Lkup::cexp(Cgen& cg) const {
+    if (is_str(type)) {
+        return "dw_ref(" + cg.var(slot) + ")";
+    } else {
+        return cg.var(slot);
+    }
+}
+
+std::string Inif::cexp(Cgen& cg) const {
+    std::string c = cond->cexp(cg);
+    std::string t = cg.temp();
+    cg.line() << c_type(type) << " " << t << ";" << std::endl;
+    cg.line() << "if (" << c << ") {" << std::endl;
+    cg.open();
+    std::string v1 = if_br->cexp(cg);
+    cg.line() << t << " = " << v1 << ";" << std::endl;
+    cg.close();
+    cg.line() << "} else {" << std::endl;
+    cg.open();
+    std::string v2 = else_br->cexp(cg);
+    cg.line() << t << " = " << v2 << ";" << std::endl;
+    cg.close();
+    cg.line() << "}" << std::endl;
+    return t;
+}
+
+std::string Negt::cexp(Cgen& cg) const {
+    return "(!" + expn->cexp(cg) + ")";
+}
+
+std::string Imus::cexp(Cgen& cg) const {
+    std::string e = expn->cexp(cg);
+    return hoist(cg, INT_T, "dw_neg(" + e + ", " + cg.where(where()) + ")");
+}
+
+//
+// short_circuit(cg,lft,rht,test)
+//
+// Gives the C code for `and` (when `test` is "") or `or` (when it is "!"),
+// only computing the right operand when the left one doesn't settle it.
+//
+static std::string short_circuit(Cgen& cg, Expn_ptr lft, Expn_ptr rht, std::string test) {
+    std::string t = hoist(cg, BOOL_T, lft->cexp(cg));
+    cg.line() << "if (" << test << t << ") {" << std::endl;
+    cg.open();
+    std::string r = rht->cexp(cg);
+    cg.line() << t << " = " << r << ";" << std::endl;
+    cg.close();
+    cg.line() << "}" << std::endl;
+    return t;
+}
+
+std::string Conj::cexp(Cgen& cg) const {
+    return short_circuit(cg, lft, rht, "");
+}
+
+std::string Disj::cexp(Cgen& cg) const {
+    return short_circuit(cg, lft, rht, "!");
+}
+
+std::string Cmlt::cexp(Cgen& cg) const {
+    std::string l = lft->cexp(cg);
+    std::string r = rht->cexp(cg);
+    return "(" + l + " < " + r + ")";
+}
+
+std::string Cmgt::cexp(Cgen& cg) const {
+    std::string l = lft->cexp(cg);
+    std::string r = rht->cexp(cg);
+    return "(" + l + " > " + r + ")";
+}
+
+std::string Cmeq::cexp(Cgen& cg) const {
+    std::string l = lft->cexp(cg);
+    std::string r = rht->cexp(cg);
+    return "(" + l + " == " + r + ")";
+}
+
+std::string Cmle::cexp(Cgen& cg) const {
+    std::string l = lft->cexp(cg);
+    std::string r = rht->cexp(cg);
+    return "(" + l + " <= " + r + ")";
+}
+
+std::string Cmge::cexp(Cgen& cg) const {
+    std::string l = lft->cexp(cg);
+    std::string r = rht->cexp(cg);
+    return "(" + l + " >= " + r + ")";
+}
+
+std::string FCll::cexp(Cgen& cg) const {
+    return hoist(cg, type, c_call(cg, name, args));
+}
+
+std::string Plus::cexp(Cgen& cg) const {
+    std::string l = left->cexp(cg);
+    std::string r = rght->cexp(cg);
+    if (is_str(type)) {
+        return "dw_cat(" + l + ", " + r + ")";
+    } else {
+        return hoist(cg, INT_T, "dw_add(" + l + ", " + r + ", " + cg.where(where()) + ")");
+    }
+}
+
+std::string Mnus::cexp(Cgen& cg) const {
+    std::string l = left->cexp(cg);
+    std::string r = rght->cexp(cg);
+    return hoist(cg, INT_T, "dw_sub(" + l + ", " + r + ", " + cg.where(where()) + ")");
+}
+
+std::string Tmes::cexp(Cgen& cg) const {
+    std::string l = left->cexp(cg);
+    std::string r = rght->cexp(cg);
+    if (is_str(type)) {
+        return hoist(cg, STR_T, "dw_repeat(" + l + ", " + r + ", " + cg.where(where()) + ")");
+    } else {
+        return hoist(cg, INT_T, "dw_mul(" + l + ", " + r + ", " + cg.where(where()) + ")");
+    }
+}
+
+std::string IDiv::cexp(Cgen& cg) const {
+    std::string l = left->cexp(cg);
+    std::string r = rght->cexp(cg);
+    return hoist(cg, INT_T, "dw_idiv(" + l + ", " + r + ", " + cg.where(where()) + ")");
+}
+
+std::string IMod::cexp(Cgen& cg) const {
+    std::string l = left->cexp(cg);
+    std::string r = rght->cexp(cg);
+    return hoist(cg, INT_T, "dw_imod(" + l + ", " + r + ", " + cg.where(where()) + ")");
+}
+
+std::string Inpt::cexp(Cgen& cg) const {
+    return hoist(cg, STR_T, "dw_input(" + expn->cexp(cg) + ")");
+}
+
+std::string IntC::cexp(Cgen& cg) const {
+    std::string e = expn->cexp(cg);
+    if (is_str(expn->type)) {
+        return hoist(cg, INT_T, "dw_int_of_str(" + e + ", " + cg.where(where()) + ")");
+    } else if (is_None(expn->type)) {
+        cg.line() << "dw_error(" << cg.where(where()) << ", "
+                  << c_quote("Run-time error: cannot convert to an int.") << ");" << std::endl;
+        return "0";
+    } else {
+        return e;
+    }
+}
+
+std::string StrC::cexp(Cgen& cg) const {
+    std::string e = expn->cexp(cg);
+    if (is_str(expn->type)) {
+        return e;
+    } else if (is_int(expn->type)) {
+        return "dw_str_of_int(" + e + ")";
+    } else if (is_bool(expn->type)) {
+        return "dw_str_of_bool(" + e + ")";
+    } else {
+        return "dw_str_of_none()";
+    }
+}
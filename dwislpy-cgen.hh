@@ -0,0 +1,80 @@
+#ifndef _DWISLPY_CGEN_H
+#define _DWISLPY_CGEN_H
+
+//
+// dwislpy-cgen.hh
+//
+// Defines `Cgen`, used by the DWISLPY ahead-of-time compiler. This is
+// selected with `--emit-c`, and writes a checked program out as C. The
+// result is compiled by any C compiler and linked with the run-time
+// support in runtime/dwislpy-rt.{h,c} (see there for how to build it).
+//
+// The translation is done by methods of the AST nodes (see dwislpy-cgen.cc),
+// in the same way that `emit` is spread over them for the bytecode:
+//
+//   * Stmt::cgen(cg) writes the C statements for a DWISLPY statement.
+//
+//   * Expn::cexp(cg) writes any C statements needed to compute the value
+//     of an expression, and gives a C expression for that value.
+//
+// Since the type of every expression is known once checked, its C type
+// is too: int, bool, and None values are `dw_int`s, and str values are
+// `dw_str*`s. Every variable of a frame becomes a C local named after
+// its slot, so the shadowing of names by `chck` needs no further work.
+//
+// An expression's C code has to produce its effects (and its errors) in
+// the same order as the interpreter. So the part of an expression that
+// could have an effect -- a call, an input, or an operation that can
+// fail -- is computed into a temporary, in order, before the expression
+// that uses it. What `cexp` gives back then has no effects of its own.
+//
+// A C expression of type `dw_str*` is a reference owned by whatever uses
+// it, which either stores it, passes it on, or drops it. A return drops
+// the strings held by the variables of its frame.
+//
+// The methods `Cgen` provides for `cgen` and `cexp` are:
+//   line  - start a new line of code at the current indentation
+//   open, close - bracket a nested C block
+//   temp  - name a new temporary
+//   ltrl  - name the static C object for a string literal
+//   where - a C string literal locating a construct, for run-time errors
+//   var   - the name of the C variable for a frame slot
+//   drops - drop the strings held by the variables of the current frame
+//
+// The `output` method writes the complete C program.
+//
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <unordered_map>
+#include "dwislpy-ast.hh"
+#include "dwislpy-check.hh"
+#include "dwislpy-util.hh"
+
+std::string c_type(Type type);
+
+class Cgen {
+public:
+    std::ostringstream code;
+    const Defs* defs = nullptr;  // The definitions of the program.
+    const SymT* frame = nullptr; // The variables of the body being written.
+    bool in_main = false;        // Whether that body is the main script.
+    //
+    std::ostream& line(void);
+    void open(void);
+    void close(void);
+    std::string temp(void);
+    std::string ltrl(const Strg& s);
+    std::string where(Locn lo) const;
+    std::string var(int slot) const;
+    void drops(void);
+    void output(std::ostream& os) const;
+private:
+    std::string indent = "";
+    int temps = 0;
+    std::vector<std::string> ltrls;
+    std::unordered_map<std::string,int> ltrl_ids;
+};
+
+#endif
@@ -3,6 +3,10 @@
 #include <vector>
 #include <memory>
 #include <unordered_map>
+#include <optional>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 #include "dwislpy-check.hh"
 #include "dwislpy-ast.hh"
@@ -87,14 +91,119 @@ Type Defn::returns(void) const {
     return ret_type;
 }
 
-SymInfo_ptr Defn::formal(int i) const {
+const SymInfo* Defn::formal(int i) const {
     return args.get_frml(i);
 }
 
-void Prgm::chck(void) {
+void Defn::sign(void) {
+    sig.clear();
+    for (unsigned int i = 0; i < arity(); i++) {
+        sig.push_back(formal(i)->type);
+    }
+}
+
+//
+// The definition whose body is being checked (by this thread), if any,
+// for the checks of its statements and expressions to note its
+// `effects`, `loops`, and `callees` in.
+//
+static thread_local Defn_ptr checking = nullptr;
+
+//
+// find_pure(order)
+//
+// Works out which of the checked definitions `order` are pure. Each
+// starts out pure unless it has effects, and any that calls one that
+// isn't stops being pure, until that settles. So a recursion among
+// pure definitions is pure.
+//
+static void find_pure(const std::vector<Defn_ptr>& order) {
+    for (Defn_ptr defn : order) {
+        defn->pure = !defn->effects;
+    }
+    for (bool changed = true; changed; ) {
+        changed = false;
+        for (Defn_ptr defn : order) {
+            for (Defn_ptr callee : defn->callees) {
+                if (defn->pure && !callee->pure) {
+                    defn->pure = false;
+                    changed = true;
+                }
+            }
+        }
+    }
+    for (Defn_ptr defn : order) {
+        defn->memoize = defn->pure && (defn->loops || !defn->callees.empty());
+    }
+}
+
+//
+// Prgm::chck(jobs)
+//
+// Checks the definitions, in the order they appear in the source, and
+// then the main script. First the signature of every definition is
+// collected by `sign`. After that, checking a definition's body reads
+// only the signatures of the others, so with `jobs` above 1 the bodies
+// are checked at once on that many threads, each taking the next body
+// still to be checked. Any errors are held until all are done, and then
+// the one that comes first in the source is raised, just as checking
+// them one at a time would. Then it works out which are pure. Each
+// definition is also numbered, as its `index`, by its place in order.
+//
+// A definition already `ready` (kept from an earlier version of the
+// program by `--serve`) has been checked, and is skipped, though it
+// still takes part in working out which are pure.
+//
+void Prgm::chck(unsigned int jobs) {
+    std::vector<Defn_ptr> order {};
     for (std::pair<Name,Defn_ptr> dfpr : defs) {
-        dfpr.second->chck(defs);
+        order.push_back(dfpr.second);
+    }
+    std::sort(order.begin(), order.end(), [](Defn_ptr d1, Defn_ptr d2) {
+        Locn l1 = d1->where();
+        Locn l2 = d2->where();
+        return l1.line() < l2.line()
+            || (l1.line() == l2.line() && l1.column() < l2.column());
+    });
+    std::vector<Defn_ptr> todo {};
+    for (unsigned int i = 0; i < order.size(); i++) {
+        order[i]->index = i;
+        if (!order[i]->ready) todo.push_back(order[i]);
+    }
+    for (Defn_ptr defn : todo) {
+        defn->sign();
+    }
+    if (jobs <= 1 || todo.size() <= 1) {
+        for (Defn_ptr defn : todo) {
+            defn->chck(defs);
+        }
+    } else {
+        std::vector<std::optional<DwislpyError>> errors(todo.size());
+        std::atomic<std::size_t> next {0};
+        Locs& locs = Locs::in_use();
+        auto work = [&](void) {
+            Locs::Use use {locs};
+            for (std::size_t i = next++; i < todo.size(); i = next++) {
+                try {
+                    todo[i]->chck(defs);
+                } catch (const DwislpyError& e) {
+                    errors[i].emplace(e);
+                }
+            }
+        };
+        std::vector<std::thread> workers;
+        for (unsigned int j = 0; j < jobs && j < todo.size(); j++) {
+            workers.emplace_back(work);
+        }
+        for (std::thread& t : workers) {
+            t.join();
+        }
+        for (std::optional<DwislpyError>& e : errors) {
+            if (e) throw *e;
+        }
     }
+    find_pure(order);
+    checking = nullptr; // (It is left set if checking a body failed.)
     if (main) {
         Rtns rtns = main->chck(Rtns{Void {}},defs, main_symt);
         if (!std::holds_alternative<Void>(rtns)) {
@@ -104,6 +213,17 @@ void Prgm::chck(void) {
 
 }
 
+//
+// Prgm::chck(s)
+//
+// Checks a statement of the main script when it is streamed, on its
+// own. (The definitions have been checked already.) It sees the
+// variables introduced by the statements of the script before it.
+//
+void Prgm::chck(Stmt_ptr s) {
+    s->chck(Rtns{Void {}},defs, main_symt);
+}
+
 Type type_of(Rtns rtns) {
     if (std::holds_alternative<VoidOr>(rtns)) {
         return std::get<VoidOr>(rtns).type;
@@ -116,7 +236,9 @@ Type type_of(Rtns rtns) {
 
 
 void Defn::chck(Defs& defs) {
+    checking = this;
     Rtns rtns = body->chck(Rtns{ret_type}, defs, args);
+    checking = nullptr;
 
     if (std::holds_alternative<Void>(rtns)) {
         throw DwislpyError(body->where(), "Definition body never returns.");
@@ -169,7 +291,9 @@ Rtns Asgn::chck([[maybe_unused]] Rtns expd, Defs& defs, SymT& symt) {
     if (!symt.has_info(name)) {
         throw DwislpyError(where(), "Variable '" + name + "' never introduced.");
     }
-    Type name_ty = symt.get_info(name)->type;
+    SymInfo_ptr info = symt.get_info(name);
+    Type name_ty = info->type;
+    slot = info->identifier;
     Type expn_ty = expn->chck(defs,symt);
     if (name_ty != expn_ty) {
         std::string msg = "Type mismatch. Expected expression of type ";
@@ -186,6 +310,7 @@ Rtns Pass::chck([[maybe_unused]] Rtns expd,
 }
 
 Rtns Prnt::chck([[maybe_unused]] Rtns expd, Defs& defs, SymT& symt) {
+    if (checking) checking->effects = true;
     for (auto expn : expns) {
         [[maybe_unused]] Type expn_ty = expn->chck(defs,symt);
     }
@@ -199,6 +324,7 @@ Rtns Ntro::chck([[maybe_unused]] Rtns expd, Defs& defs, SymT& symt) {
 
     auto expn_type = expn->chck(defs, symt);
     symt.add_locl(name, expn_type);
+    slot = symt.get_info(name)->identifier;
     return Rtns {Void {}}; 
 }
 
@@ -207,7 +333,7 @@ Rtns FRtn::chck(Rtns expd,
 
     Type expd_ty = type_of(expd);
 
-    if ((expn.get() == nullptr)) {
+    if ((expn == nullptr)) {
         throw DwislpyError(where(), "The return value does not exist but should return " + get_type_str(expd_ty));
     } else {
         auto actual_tp = expn->chck(defs, symt);
@@ -248,12 +374,14 @@ Rtns PCll::chck([[maybe_unused]] Rtns expd, Defs& defs, SymT& symt) {
     if (fn_iter == defs.end()) throw DwislpyError(where(), "fn " + name + " does not exsits in the context");
     
     Defn_ptr fn = fn_iter->second;
+    defn = fn;
+    if (checking) checking->callees.push_back(fn);
 
-    if (fn->arity() != args.size()) 
-        throw DwislpyError {where(), "fn  needs " + std::to_string(fn->arity()) + " number of args but got " + std::to_string(args.size())};
+    if (fn->sig.size() != args.size()) 
+        throw DwislpyError {where(), "fn  needs " + std::to_string(fn->sig.size()) + " number of args but got " + std::to_string(args.size())};
 
-    for (std::size_t i = 0; i < fn->arity(); i++) {
-        auto fm_arg_tp = fn->args.get_frml(i)->type;
+    for (std::size_t i = 0; i < fn->sig.size(); i++) {
+        auto fm_arg_tp = fn->sig[i];
         auto ac_arg_tp = args[i]->chck(defs, symt);
         if (fm_arg_tp != ac_arg_tp) {
             throw DwislpyError(where(), "The argument at " + std::to_string(i) + " should have type " + get_type_str(fm_arg_tp) + " but got " + get_type_str(ac_arg_tp));
@@ -293,7 +421,7 @@ Rtns Cond::chck(Rtns expd, Defs& defs, SymT& symt) {
     const bool rt_has_void = has_void(return_pt);
 
     for (std::size_t i = 1; i < ifcds.size(); i++) {
-        auto body_rt_tp = ifcds[0]->body->chck(expd, defs, symt);
+        auto body_rt_tp = ifcds[i]->body->chck(expd, defs, symt);
 
         const bool body_has_void = has_void(body_rt_tp);
         const bool body_is_void = std::holds_alternative<Void>(body_rt_tp);
@@ -314,6 +442,14 @@ Rtns Cond::chck(Rtns expd, Defs& defs, SymT& symt) {
         }
     }
 
+    if (!els) {
+        // Without an else, none of the bodies might run.
+        if (!rt_is_void) {
+            return_pt = VoidOr { type_of(return_pt) };
+        }
+        return return_pt;
+    }
+
     auto body_rt_tp = els->body->chck(expd, defs, symt);
 
     const bool body_has_void = has_void(body_rt_tp);
@@ -343,6 +479,7 @@ Rtns Whil::chck(Rtns expd, Defs& defs, SymT& symt) {
     // It should summarize the return behavior. It shouldv be Void
     // or VoidOr because loop bodies don't always execute.
 
+    if (checking) checking->loops = true;
     auto cond_tp = cond->chck(defs, symt);
     if (cond_tp != BOOL_T) 
         throw DwislpyError(where(), "The condition for while should have type Bool but got " + get_type_str(cond_tp));
@@ -356,6 +493,7 @@ Rtns Whil::chck(Rtns expd, Defs& defs, SymT& symt) {
 }
 
 Rtns Rept::chck(Rtns expd, Defs &defs, SymT &symt) {
+    if (checking) checking->loops = true;
     auto cond_tp = cond->chck(defs, symt);
     if (cond_tp != BOOL_T) throw DwislpyError(where(), "The condition for repeat should have type Bool but got " + get_type_str(cond_tp));
 
@@ -371,9 +509,9 @@ Type Plus::chck(Defs& defs, SymT& symt) {
     Type left_ty = left->chck(defs,symt);
     Type rght_ty = rght->chck(defs,symt);
     if (is_int(left_ty) && is_int(rght_ty)) {
-        return INT_T;
+        return type = INT_T;
     } else if (is_str(left_ty) && is_str(rght_ty)) {
-        return STR_T;
+        return type = STR_T;
     } else {
         std::string msg = "Wrong operand types for plus.";
         throw DwislpyError { where(), msg };
@@ -385,7 +523,7 @@ Type Mnus::chck(Defs& defs, SymT& symt) {
     Type left_ty = left->chck(defs,symt);
     Type rght_ty = rght->chck(defs,symt);
     if (is_int(left_ty) && is_int(rght_ty)) {
-        return INT_T;
+        return type = INT_T;
     } else {
         std::string msg = "Wrong operand types for minus.";
         throw DwislpyError { where(), msg };
@@ -397,9 +535,9 @@ Type Tmes::chck(Defs& defs, SymT& symt) {
     Type left_ty = left->chck(defs,symt);
     Type rght_ty = rght->chck(defs,symt);
     if (is_int(left_ty) && is_int(rght_ty)) {
-        return INT_T;
+        return type = INT_T;
     } else if (is_str(left_ty) && is_int(rght_ty)) {
-        return STR_T;
+        return type = STR_T;
     } else {
         std::string msg = "Wrong operand types for times.";
         throw DwislpyError { where(), msg };
@@ -412,7 +550,7 @@ Type IDiv::chck(Defs& defs, SymT& symt) {
     Type left_ty = left->chck(defs,symt);
     Type rght_ty = rght->chck(defs,symt);
     if (is_int(left_ty) && is_int(rght_ty)) {
-        return INT_T;
+        return type = INT_T;
     } else {
         std::string msg = "Wrong operand types for div.";
         throw DwislpyError { where(), msg };
@@ -424,7 +562,7 @@ Type IMod::chck(Defs& defs, SymT& symt) {
     Type left_ty = left->chck(defs,symt);
     Type rght_ty = rght->chck(defs,symt);
     if (is_int(left_ty) && is_int(rght_ty)) {
-        return INT_T;
+        return type = INT_T;
     } else {
         std::string msg = "Wrong operand types for mod.";
         throw DwislpyError { where(), msg };
@@ -434,7 +572,7 @@ Type IMod::chck(Defs& defs, SymT& symt) {
 Type Imus::chck(Defs &defs, SymT &symt) {
     Type expn_ty = expn->chck(defs,symt);
     if (is_int(expn_ty)) {
-        return INT_T;
+        return type = INT_T;
     } else {
         std::string msg = "Wrong operand types for inplace minus.";
         throw DwislpyError { where(), msg };
@@ -447,6 +585,7 @@ Rtns Pleq::chck([[maybe_unused]]Rtns expd, Defs& defs, SymT& symt) {
         throw DwislpyError { where(), msg };
     }
     auto stored = symt.get_info(name);
+    slot = stored->identifier;
     Type left_ty = stored->type;
     Type rght_ty = expn->chck(defs,symt);
     if (is_int(left_ty) && is_int(rght_ty)) {
@@ -466,6 +605,7 @@ Rtns Mneq::chck([[maybe_unused]]Rtns expd, Defs& defs, SymT& symt) {
         throw DwislpyError { where(), msg };
     }
     auto stored = symt.get_info(name);
+    slot = stored->identifier;
     Type left_ty = stored->type;
     Type rght_ty = expn->chck(defs,symt);
     if (is_int(left_ty) && is_int(rght_ty)) {
@@ -484,7 +624,7 @@ Type Cmlt::chck(Defs& defs, SymT& symt) {
         std::string msg = "Wrong operand types for <.";
         throw DwislpyError { where(), msg };
     }
-    return BOOL_T; 
+    return type = BOOL_T; 
 }
 
 Type Inif::chck(Defs &defs, SymT &symt) {
@@ -500,7 +640,7 @@ Type Inif::chck(Defs &defs, SymT &symt) {
         throw DwislpyError{where(), "The branches should have the same type"};
     }
 
-    return if_br_ty;
+    return type = if_br_ty;
 }
 
 Type Cmle::chck(Defs& defs, SymT& symt) {
@@ -511,7 +651,7 @@ Type Cmle::chck(Defs& defs, SymT& symt) {
         std::string msg = "Wrong operand types for <=.";
         throw DwislpyError { where(), msg };
     }
-    return BOOL_T; 
+    return type = BOOL_T; 
 }
 
 Type Cmeq::chck(Defs& defs, SymT& symt) {
@@ -522,7 +662,7 @@ Type Cmeq::chck(Defs& defs, SymT& symt) {
         std::string msg = "Wrong operand types for ==.";
         throw DwislpyError { where(), msg };
     }
-    return BOOL_T; 
+    return type = BOOL_T; 
 }
 
 Type Cmge::chck(Defs& defs, SymT& symt) {
@@ -533,7 +673,7 @@ Type Cmge::chck(Defs& defs, SymT& symt) {
         std::string msg = "Wrong operand types for >=.";
         throw DwislpyError { where(), msg };
     }
-    return BOOL_T; 
+    return type = BOOL_T; 
 }
 
 Type Cmgt::chck(Defs& defs, SymT& symt) {
@@ -544,7 +684,7 @@ Type Cmgt::chck(Defs& defs, SymT& symt) {
         std::string msg = "Wrong operand types for >.";
         throw DwislpyError { where(), msg };
     }
-    return BOOL_T; 
+    return type = BOOL_T; 
 }
 Type Conj::chck(Defs& defs, SymT& symt) {
     Type left_ty = lft->chck(defs,symt);
@@ -554,7 +694,7 @@ Type Conj::chck(Defs& defs, SymT& symt) {
         std::string msg = "Wrong operand types for and.";
         throw DwislpyError { where(), msg };
     }
-    return BOOL_T; 
+    return type = BOOL_T; 
 }
 
 Type Disj::chck(Defs& defs, SymT& symt) {
@@ -565,7 +705,7 @@ Type Disj::chck(Defs& defs, SymT& symt) {
         std::string msg = "Wrong operand types for or.";
         throw DwislpyError { where(), msg };
     }
-    return BOOL_T; 
+    return type = BOOL_T; 
 }
 
 Type Negt::chck(Defs& defs, SymT& symt) {
@@ -575,48 +715,51 @@ Type Negt::chck(Defs& defs, SymT& symt) {
         std::string msg = "Wrong operand types for not.";
         throw DwislpyError { where(), msg };
     }
-    return BOOL_T; 
+    return type = BOOL_T; 
 }
 
 Type Ltrl::chck([[maybe_unused]] Defs& defs, [[maybe_unused]] SymT& symt) {
-    if (std::holds_alternative<int>(valu)) {
-        return INT_T;
-    } else if (std::holds_alternative<std::string>(valu)) {
-        return STR_T;
+    if (holds_int(valu)) {
+        return type = INT_T;
+    } else if (std::holds_alternative<Strg>(valu)) {
+        return type = STR_T;
     } if (std::holds_alternative<bool>(valu)) {
-        return BOOL_T;
+        return type = BOOL_T;
     } else {
-        return NONE_T;
+        return type = NONE_T;
     } 
 }
 
 Type Lkup::chck([[maybe_unused]] Defs& defs, SymT& symt) {
     if (symt.has_info(name)) {
-        return symt.get_info(name)->type;
+        SymInfo_ptr info = symt.get_info(name);
+        slot = info->identifier;
+        return type = info->type;
     } else {
         throw DwislpyError {where(), "Unknown identifier " + name + "."};
     } 
 }
 
 Type Inpt::chck(Defs& defs, SymT& symt) {
+    if (checking) checking->effects = true;
     Type expr_ty = expn->chck(defs,symt);
     if (!is_str(expr_ty)) {
         throw DwislpyError {where(), "Input requires a string."};
     }
-    return STR_T; 
+    return type = STR_T; 
 }
 
 Type IntC::chck(Defs& defs, SymT& symt) {
     Type expr_ty = expn->chck(defs,symt);
-    if (!is_str(expr_ty) || !is_int(expr_ty)) {
+    if (!is_str(expr_ty) && !is_int(expr_ty)) {
         throw DwislpyError {where(), "Input requires a string or integer."};
     }
-    return INT_T; 
+    return type = INT_T; 
 }
 
 Type StrC::chck(Defs& defs, SymT& symt) {
     expn->chck(defs,symt);
-    return STR_T; 
+    return type = STR_T; 
 }
 
 
@@ -633,16 +776,268 @@ Type FCll::chck(Defs& defs, SymT& symt) {
     if (fn_iter == defs.end()) throw DwislpyError(where(), "fn " + name + " does not exsits in the context");
     
     Defn_ptr fn = fn_iter->second;
+    defn = fn;
+    if (checking) checking->callees.push_back(fn);
 
-    if (fn->arity() != args.size()) throw DwislpyError {where(), "fn  needs " + std::to_string(fn->arity()) + " number of args but got " + std::to_string(args.size())};
+    if (fn->sig.size() != args.size()) throw DwislpyError {where(), "fn  needs " + std::to_string(fn->sig.size()) + " number of args but got " + std::to_string(args.size())};
 
-    for (std::size_t i = 0; i < fn->arity(); i++) {
-        auto fm_arg_tp = fn->args.get_frml(i)->type;
+    for (std::size_t i = 0; i < fn->sig.size(); i++) {
+        auto fm_arg_tp = fn->sig[i];
         auto ac_arg_tp = args[i]->chck(defs, symt);
         if (fm_arg_tp != ac_arg_tp) {
             throw DwislpyError(where(), "The argument at " + std::to_string(i) + " should have type " + get_type_str(fm_arg_tp) + "but got " + get_type_str(ac_arg_tp));
         }
     }
 
-    return fn->ret_type;
+    return type = fn->ret_type;
+}
+
+//
+// Prgm::spcl, Stmt::spcl, Expn::spcl
+//
+// Specializes a checked program. Each statement specializes the
+// expressions it holds, replacing each by the result of its `spcl`.
+// An expression specializes its own sub-expressions and then gives
+// either itself or one of the typed nodes declared at the end of
+// dwislpy-ast.hh, chosen using the `type`s recorded by `chck`.
+//
+
+template <class Q, class N>
+static Expn_ptr quicken(const N& node) {
+    Q* q { new Q {node.left, node.rght, node.where()} };
+    q->type = node.type;
+    return q;
+}
+
+void Prgm::spcl(void) {
+    for (auto [name, defn] : defs) {
+        if (defn->ready) continue;
+        defn->spcl();
+        defn->ready = true;
+    }
+    if (main) {
+        main->spcl();
+    }
+}
+
+void Defn::spcl(void) {
+    body->spcl();
+}
+
+void Blck::spcl(void) {
+    for (Stmt_ptr s : stmts) {
+        s->spcl();
+    }
+}
+
+void Asgn::spcl(void) {
+    expn = expn->spcl(expn);
+}
+
+void Ntro::spcl(void) {
+    expn = expn->spcl(expn);
+}
+
+void Pleq::spcl(void) {
+    expn = expn->spcl(expn);
+}
+
+void Mneq::spcl(void) {
+    expn = expn->spcl(expn);
+}
+
+void Cond::spcl(void) {
+    for (Ifcd_ptr ifcd : ifcds) {
+        ifcd->spcl();
+    }
+    if (els) {
+        els->spcl();
+    }
+}
+
+void Ifcd::spcl(void) {
+    cond = cond->spcl(cond);
+    body->spcl();
+}
+
+void Else::spcl(void) {
+    body->spcl();
+}
+
+void Whil::spcl(void) {
+    cond = cond->spcl(cond);
+    body->spcl();
+}
+
+void Rept::spcl(void) {
+    cond = cond->spcl(cond);
+    body->spcl();
+}
+
+void FRtn::spcl(void) {
+    expn = expn->spcl(expn);
+}
+
+void Prnt::spcl(void) {
+    for (Expn_ptr& e : expns) {
+        e = e->spcl(e);
+    }
+}
+
+void PCll::spcl(void) {
+    for (Expn_ptr& e : args) {
+        e = e->spcl(e);
+    }
+}
+
+Expn_ptr Expn::spcl(Expn_ptr self) {
+    return self;
+}
+
+Expn_ptr Inif::spcl(Expn_ptr self) {
+    if_br = if_br->spcl(if_br);
+    cond = cond->spcl(cond);
+    else_br = else_br->spcl(else_br);
+    return self;
+}
+
+Expn_ptr Negt::spcl(Expn_ptr self) {
+    expn = expn->spcl(expn);
+    return self;
+}
+
+Expn_ptr Imus::spcl(Expn_ptr self) {
+    expn = expn->spcl(expn);
+    return self;
+}
+
+Expn_ptr Conj::spcl(Expn_ptr self) {
+    lft = lft->spcl(lft);
+    rht = rht->spcl(rht);
+    return self;
+}
+
+Expn_ptr Disj::spcl(Expn_ptr self) {
+    lft = lft->spcl(lft);
+    rht = rht->spcl(rht);
+    return self;
+}
+
+Expn_ptr Cmlt::spcl(Expn_ptr self) {
+    lft = lft->spcl(lft);
+    rht = rht->spcl(rht);
+    return self;
+}
+
+Expn_ptr Cmgt::spcl(Expn_ptr self) {
+    lft = lft->spcl(lft);
+    rht = rht->spcl(rht);
+    return self;
+}
+
+Expn_ptr Cmeq::spcl(Expn_ptr self) {
+    lft = lft->spcl(lft);
+    rht = rht->spcl(rht);
+    return self;
+}
+
+Expn_ptr Cmle::spcl(Expn_ptr self) {
+    lft = lft->spcl(lft);
+    rht = rht->spcl(rht);
+    return self;
+}
+
+Expn_ptr Cmge::spcl(Expn_ptr self) {
+    lft = lft->spcl(lft);
+    rht = rht->spcl(rht);
+    return self;
+}
+
+Expn_ptr FCll::spcl(Expn_ptr self) {
+    for (Expn_ptr& e : args) {
+        e = e->spcl(e);
+    }
+    return self;
+}
+
+Expn_ptr Plus::spcl(Expn_ptr self) {
+    left = left->spcl(left);
+    rght = rght->spcl(rght);
+    if (is_int(type)) {
+        return quicken<IntPlus>(*this);
+    } else if (is_str(type)) {
+        //
+        // Flatten a chain like `a + b + c` into the one node so that
+        // it is evaluated by a single concatenation.
+        //
+        Expn_ptr e = quicken<StrPlus>(*this);
+        StrPlus& sp = static_cast<StrPlus&>(*e);
+        for (Expn_ptr opnd : {left, rght}) {
+            if (auto chain = dynamic_cast<StrPlus*>(opnd)) {
+                sp.parts.insert(sp.parts.end(), chain->parts.begin(), chain->parts.end());
+            } else {
+                sp.parts.push_back(opnd);
+            }
+        }
+        return e;
+    } else {
+        return self;
+    }
+}
+
+Expn_ptr Mnus::spcl(Expn_ptr self) {
+    left = left->spcl(left);
+    rght = rght->spcl(rght);
+    if (is_int(type)) {
+        return quicken<IntMnus>(*this);
+    } else {
+        return self;
+    }
+}
+
+Expn_ptr Tmes::spcl(Expn_ptr self) {
+    left = left->spcl(left);
+    rght = rght->spcl(rght);
+    if (is_int(type)) {
+        return quicken<IntTmes>(*this);
+    } else if (is_str(type)) {
+        return quicken<StrTmes>(*this);
+    } else {
+        return self;
+    }
+}
+
+Expn_ptr IDiv::spcl(Expn_ptr self) {
+    left = left->spcl(left);
+    rght = rght->spcl(rght);
+    if (is_int(type)) {
+        return quicken<IntIDiv>(*this);
+    } else {
+        return self;
+    }
+}
+
+Expn_ptr IMod::spcl(Expn_ptr self) {
+    left = left->spcl(left);
+    rght = rght->spcl(rght);
+    if (is_int(type)) {
+        return quicken<IntIMod>(*this);
+    } else {
+        return self;
+    }
+}
+
+Expn_ptr Inpt::spcl(Expn_ptr self) {
+    expn = expn->spcl(expn);
+    return self;
+}
+
+Expn_ptr IntC::spcl(Expn_ptr self) {
+    expn = expn->spcl(expn);
+    return self;
+}
+
+Expn_ptr StrC::spcl(Expn_ptr self) {
+    expn = expn->spcl(expn);
+    return self;
 }
@@ -161,6 +161,14 @@ typedef std::variant<Void,VoidOr,Type> Rtns;
 // introduced x within the body) we provide support for distinguishing variables
 // by an integer index `identifier`.
 //
+// That identifier doubles as the variable's slot in its run-time frame.
+// Formals are added first (by the parser) and so occupy slots 0, 1, 2,
+// etc. Every local or temporary gets a fresh slot after those, even when
+// it shadows another variable. The method `get_size` reports how many
+// slots a frame for this symbol table needs, and `get_slot` gives the
+// information of the variable in a slot, even once its scope has been
+// popped.
+//
 // You can add variables to symbol table using `add_frml`, `add_locl`, `add_temp`.
 // You can check the symbol table with `has_info`.
 // You can get a variable's information with `get_info`.
@@ -174,6 +182,14 @@ typedef std::variant<Void,VoidOr,Type> Rtns;
 // 3rd, etc parameter's information. The method `get_frmls_size` tells you
 // how many formal parameters are stored in a symbol table.
 //
+// The table keeps the information of every variable in one array, by
+// slot, and a single map from each name to the slot of the innermost
+// variable of that name now in scope. Scopes are opened by `mark` and
+// closed by `pop_until_mark`. Adding a variable records both its scope
+// and whatever it shadows, and closing a scope puts back what each of
+// its variables shadowed. So a lookup is one probe of the map, and
+// closing a scope costs one step for each variable that it introduced.
+//
 
 enum SymKind { FRML, LOCL, TEMP };
 
@@ -190,72 +206,109 @@ public:
         name {nm}, identifier {id}, type {ty}, kind {kd} {}
 };
 
-typedef std::shared_ptr<SymInfo> SymInfo_ptr;
+typedef SymInfo* SymInfo_ptr;
 
 //
 // class SymT - convenient cover to a dictionary of Name-SymInfo_ptr pairs.
 //
 class SymT {
 public:
-    SymT() : sym_tables { {} }, formals {} { }
+    SymT() { }
     std::string add_frml(std::string nm, Type ty) {
-        sym_tables.front()[nm] = SymInfo_ptr{ new SymInfo {nm, ty, 0, FRML} };
-        formals.push_back(nm);
+        formals.push_back(add_info(nm, ty, FRML));
         return nm;
     }
     std::string add_locl(std::string nm, Type ty) {
-        sym_tables.front()[nm] = SymInfo_ptr{ new SymInfo {nm, ty, sym_id++, FRML} };
+        add_info(nm, ty, LOCL);
         return nm;
     }
     std::string add_temp(std::string nm, Type ty) {
-        sym_tables.front()[nm] = SymInfo_ptr{ new SymInfo {nm, ty, sym_id++, TEMP} };
+        add_info(nm, ty, TEMP);
         return nm;
     }
-    bool has_info(std::string nm) const {
-        return std::any_of(sym_tables.begin(), sym_tables.end(),
-            [&nm](const std::unordered_map<std::string,SymInfo_ptr> &sym_table) {
-                return sym_table.find(nm) != sym_table.end();
-            });
+    bool has_info(const std::string& nm) const {
+        return visible.find(nm) != visible.end();
     }
-    SymInfo_ptr get_info(std::string nm) const {
-        for (auto sym_table : sym_tables) {
-            if (sym_table.count(nm))
-                return sym_table.at(nm);
+    SymInfo_ptr get_info(const std::string& nm) {
+        auto it = visible.find(nm);
+        if (it == visible.end()) {
+            throw std::runtime_error("No symbol table entry for " + nm);
         }
-
-        throw std::runtime_error("No symbol table entry for " + nm);
+        return &slots[it->second];
     }
-    SymInfo_ptr get_frml(int i) const {
-        return this->get_info(formals[i]);
+    const SymInfo* get_frml(int i) const {
+        return &slots[formals[i]];
     }
     unsigned int get_frmls_size(void) const {
         return formals.size();
     }
+    unsigned int get_size(void) const {
+        return slots.size();
+    }
+    const SymInfo* get_slot(int i) const {
+        return &slots[i];
+    }
     void mark(void) {
-        sym_tables.push_front( {} );
+        marks.push_back(added.size());
     }
     void pop_until_mark(void) {
-        sym_tables.pop_front();
+        std::size_t start = marks.back();
+        marks.pop_back();
+        while (added.size() > start) {
+            const Added& ad = added.back();
+            if (ad.shadows < 0) {
+                visible.erase(slots[ad.slot].name);
+            } else {
+                visible[slots[ad.slot].name] = ad.shadows;
+            }
+            added.pop_back();
+        }
     }
 
     void output(std::ostream &out) const {
-        size_t i = 0;
-        for (auto sym_table : sym_tables) {
-            out << "Symbol table " << i++ << std::endl;
-            for (auto sym : sym_table) {
-                out << sym.first << " " << sym.second->identifier << " " << get_type_str(sym.second->type) << " " << sym.second->kind << std::endl;
+        // Innermost scope first, as each appears in `added`.
+        std::size_t end = added.size();
+        for (std::size_t i = 0; i <= marks.size(); i++) {
+            std::size_t start = i < marks.size() ? marks[marks.size() - 1 - i] : 0;
+            out << "Symbol table " << i << std::endl;
+            for (std::size_t j = start; j < end; j++) {
+                const SymInfo& sym = slots[added[j].slot];
+                out << sym.name << " " << sym.identifier << " " << get_type_str(sym.type) << " " << sym.kind << std::endl;
             }
             out << std::endl;
+            end = start;
         }
     }
 
-    bool is_redefining(std::string nm) const {
-        return sym_tables.front().count(nm) > 0;
+    bool is_redefining(const std::string& nm) const {
+        auto it = visible.find(nm);
+        return it != visible.end() && depths[it->second] == marks.size();
     }
 private:
-    std::deque<std::unordered_map<std::string, SymInfo_ptr>> sym_tables;
-    std::vector<std::string> formals;
-    int sym_id = 0;
+    int add_info(const std::string& nm, Type ty, SymKind kd) {
+        int id = slots.size();
+        slots.emplace_back(nm, ty, id, kd);
+        depths.push_back(marks.size());
+        auto [it, fresh] = visible.try_emplace(nm, id);
+        added.push_back(Added {id, fresh ? -1 : it->second});
+        it->second = id;
+        return id;
+    }
+    //
+    // Added - a variable added to the current scope, and the slot of the
+    // variable of the same name that it shadows, if any (else -1).
+    //
+    class Added {
+    public:
+        int slot;
+        int shadows;
+    };
+    std::deque<SymInfo> slots;       // Every variable, by slot.
+    std::vector<std::size_t> depths; // The scope depth of each slot.
+    std::unordered_map<std::string,int> visible;
+    std::vector<Added> added;
+    std::vector<std::size_t> marks;  // Where each open scope starts in `added`.
+    std::vector<int> formals;
 };
 
 #endif
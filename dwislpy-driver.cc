@@ -0,0 +1,413 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "dwislpy-ast.hh"
+#include "dwislpy-flex.hh"
+#include "dwislpy-bison.tab.hh"
+#include "dwislpy-util.hh"
+#include "dwislpy-vm.hh"
+#include "dwislpy-cgen.hh"
+#include "dwislpy-cache.hh"
+#include "dwislpy-prof.hh"
+#include "dwislpy-main.hh"
+
+//
+// dwislpy-driver.cc
+//
+// The methods of DWISLPY::Driver (see dwislpy-main.hh), which puts the
+// lexer, parser, checker, optimizer, and the engines that run the
+// program together. It is used by the `dwislpy` command (dwislpy-main.cc)
+// and by libdwislpy (dwislpy-lib.cc).
+//
+
+// * * * * *
+//
+// DWISLPY::Driver methods.
+//
+// This class just houses the components of the DWISLPY interpreter.
+// We wrote it this way just to prevent some deallocation errors
+// due to sharing pointers in our interfacing with Flex/Bison, programs
+// built in a more permissive error (and originally for C).
+//
+
+DWISLPY::Driver::Driver(std::string filename) :
+    src_name {filename},
+    src {filename}
+{ }
+
+DWISLPY::Driver::Driver(std::string name, std::string_view text) :
+    src_name {name},
+    src {Srce::Given {text}}
+{ }
+
+// parse
+//
+// Checks the file's stream, builds the lexer for it, then parses the
+// file's contents. The parser sets the `prgm` AST using the `set`
+// method.
+//
+void DWISLPY::Driver::parse(void) {
+    if (!src.good()) {
+        Locn locn {src_name};
+        std::string mesg = "Unable to open file. Does the file exist?";
+        throw DwislpyError {locn, mesg};
+    }
+    lexer = Lexer_ptr { new DWISLPY::Lexer { src, src_name } };
+    DWISLPY::Lexer& lexer_local = *lexer;
+    parser = Parser_ptr { new DWISLPY::Parser { lexer_local, *this } };
+    Arena::Use use {nodes()};
+    parser->parse();
+}
+
+// set
+//
+// Sets the program being parsed, once its definitions are. When it is
+// being streamed, they are checked and optimized straight away, and
+// then the parse goes on with the nodes of the main script made in the
+// arena `script`, until the Arena::Use in `parse` puts back the one
+// before.
+//
+void DWISLPY::Driver::set(Prgm_ptr prgm) {
+    program = prgm;
+    if (!streaming) {
+        return;
+    }
+    check(stream_jobs);
+    optimize(stream_level);
+    stck.max_depth = max_depth ? max_depth : MAX_DEPTH;
+    stck.stack_end = stack_limit();
+    stck.memo = memo;
+    if (memo) {
+        stck.memos.resize(program->defs.size());
+    }
+    located = locs.entries.size();
+    Arena::current = &script;
+}
+
+// step
+//
+// When streaming, checks, optimizes, and runs a statement of the main
+// script just parsed, then forgets it: its nodes, and the locations
+// they were given. Once a statement returns, those after it are only
+// parsed. Otherwise, gives false, and the statement is kept for the
+// program's main script.
+//
+bool DWISLPY::Driver::step(Stmt_ptr stmt) {
+    if (!streaming) {
+        return false;
+    }
+    if (!stopped) {
+        program->chck(stmt);
+        for (Stmt_ptr s : program->optm(stmt, stream_level)) {
+            s->spcl();
+            if (!program->run(s, stck)) {
+                stopped = true;
+                break;
+            }
+        }
+    }
+    script.clear();
+    locs.truncate(located);
+    return true;
+}
+
+// stream
+//
+// Parses and runs the DwiSlpy program at once, for a long script. Its
+// definitions are checked, with `jobs`, and optimized at `level`, once
+// they have all been parsed, and then each statement of its main script
+// is checked, optimized, and run as soon as it has been parsed (see
+// `step`). So output starts straight away, and the syntax tree only
+// ever holds the definitions and one statement of the script. But an
+// error in a statement is only reported once those before it have run.
+//
+void DWISLPY::Driver::stream(unsigned int jobs, int level) {
+    streaming = true;
+    stream_jobs = jobs;
+    stream_level = level;
+    parse();
+}
+
+// run
+//
+// Runs the DwiSlpy program.
+//
+void DWISLPY::Driver::run(void) {
+    program->run(nullptr, max_depth ? max_depth : MAX_DEPTH, memo);
+}
+
+// check
+//
+// Checks the DwiSlpy program, resolving each variable to a frame slot.
+// With `jobs` above 1, the bodies of its definitions are checked in
+// parallel.
+//
+void DWISLPY::Driver::check(unsigned int jobs) {
+    program->chck(jobs);
+}
+
+// optimize
+//
+// Simplifies the checked DwiSlpy program at the given -O level, then
+// specializes its code according to the types found by `check`.
+//
+void DWISLPY::Driver::optimize(int level) {
+    Arena::Use use {nodes()};
+    program->optm(level);
+    program->spcl();
+}
+
+// compile
+//
+// Lowers the checked DwiSlpy program into bytecode.
+//
+void DWISLPY::Driver::compile(void) {
+    bytecode = Bytc_ptr { new Bytc {} };
+    program->emit(*bytecode);
+}
+
+// run_vm
+//
+// Runs the compiled DwiSlpy program on the bytecode machine.
+//
+void DWISLPY::Driver::run_vm(void) {
+    Mach {*bytecode, max_depth ? max_depth : VM_MAX_DEPTH}.run();
+}
+
+// dump_vm
+//
+// Outputs a listing of the compiled DwiSlpy program.
+//
+void DWISLPY::Driver::dump_vm(void) {
+    bytecode->dump(std::cout);
+}
+
+// run_tiered
+//
+// Runs the DwiSlpy program on the interpreter, handing its hot code over
+// to the bytecode machine as it goes.
+//
+void DWISLPY::Driver::run_tiered(void) {
+    Tier tier {program->defs, max_depth ? max_depth : VM_MAX_DEPTH};
+    program->run(&tier, max_depth ? max_depth : MAX_DEPTH, memo);
+}
+
+// run_profiled
+//
+// Runs the DwiSlpy program on the interpreter, then writes its profile
+// (see dwislpy-prof.hh) to `<name>.prof` and its stacks to
+// `<name>.folded`. They are written even if the program fails.
+//
+void DWISLPY::Driver::run_profiled(const std::string& name) {
+    Prof prof {};
+    auto write = [&](void) {
+        prof.finish();
+        std::ofstream report {name + ".prof"};
+        prof.report(report, src_name, src.text());
+        std::ofstream stacks {name + ".folded"};
+        prof.stacks(stacks);
+    };
+    try {
+        program->run(nullptr, max_depth ? max_depth : MAX_DEPTH, memo, &prof);
+    } catch (...) {
+        write();
+        throw;
+    }
+    write();
+}
+
+// emit_c
+//
+// Outputs the checked DwiSlpy program as a C program.
+//
+void DWISLPY::Driver::emit_c(void) {
+    Cgen cg {};
+    program->cgen(cg);
+    cg.output(std::cout);
+}
+
+// load_cache
+//
+// Loads the bytecode saved by an earlier run of the same source with the
+// same options (see `cache_options`), if there is one. Either way,
+// remembers where it is kept for `save_cache`.
+//
+bool DWISLPY::Driver::load_cache(const std::string& dir, int level) {
+    if (!src.good() || dir.empty()) {
+        return false;
+    }
+    cache_opts = cache_options(level);
+    cache_file = cache_path(dir, src.text(), cache_opts);
+    Bytc_ptr bc { new Bytc {} };
+    if (!load_bytc(cache_file, src.text(), cache_opts, src_name, *bc)) {
+        return false;
+    }
+    bytecode = bc;
+    return true;
+}
+
+// save_cache
+//
+// Saves the compiled bytecode for later runs, if `load_cache` was used.
+//
+void DWISLPY::Driver::save_cache(void) {
+    if (!cache_file.empty()) {
+        save_bytc(cache_file, src.text(), cache_opts, *bytecode);
+    }
+}
+
+// refresh
+//
+// For `--serve`: reads the source file again and, if its text has changed
+// since the last refresh, parses, checks, and optimizes it anew. Any of
+// the definitions that can be kept from the program before (see `keep`)
+// are used as they are, so only the others are checked and optimized.
+// Should that fail, the program before stays.
+//
+// The nodes of each version are kept in an arena of their own, since a
+// kept definition may have been parsed many versions ago. After
+// REPARSE_MAX of them, it starts over from none, locations and all.
+//
+static const std::size_t REPARSE_MAX = 16;
+
+bool DWISLPY::Driver::refresh(unsigned int jobs, int level) {
+    Srce fresh {src_name};
+    if (!fresh.good()) {
+        Locn locn {src_name};
+        std::string mesg = "Unable to open file. Does the file exist?";
+        throw DwislpyError {locn, mesg};
+    }
+    if (program && fresh.text() == served) {
+        return false;
+    }
+    if (reparsed.size() >= REPARSE_MAX) {
+        program = nullptr;
+        bytecode = nullptr;
+        served.clear();
+        reparsed.clear();
+        locs.clear();
+    }
+    Prgm_ptr old = program;
+    reparsed.push_back(std::unique_ptr<Arena> {new Arena {}});
+    try {
+        lexer = Lexer_ptr { new DWISLPY::Lexer { fresh, src_name } };
+        parser = Parser_ptr { new DWISLPY::Parser { *lexer, *this } };
+        {
+            Arena::Use use {nodes()};
+            parser->parse();
+        }
+        if (old) {
+            keep(old, served, fresh.text());
+        }
+        check(jobs);
+        optimize(level);
+    } catch (...) {
+        program = old;
+        throw;
+    }
+    served = std::string {fresh.text()};
+    return true;
+}
+
+//
+// def_texts(prgm,text)
+//
+// The source text of each definition of a program: from the start of
+// the line of its `def` to the start of the next definition, or of the
+// main script, or else to the end of the source. (A definition is
+// located by the first statement of its body, and a `def` only ever
+// starts a line.)
+//
+static std::unordered_map<Defn_ptr,std::string_view> def_texts(const Prgm& prgm, std::string_view text) {
+    std::vector<std::size_t> lines {0};
+    for (std::size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '\n') lines.push_back(i + 1);
+    }
+    auto start = [&](int line) {
+        if (line < 1 || static_cast<std::size_t>(line) > lines.size()) {
+            return text.size();
+        }
+        return lines[line - 1];
+    };
+    std::unordered_map<Defn_ptr,std::size_t> starts {};
+    std::vector<std::size_t> bounds {text.size()};
+    for (auto [name, defn] : prgm.defs) {
+        int line = defn->where().line();
+        while (line > 1 && text.substr(start(line), 4) != "def ") {
+            line--;
+        }
+        starts[defn] = start(line);
+        bounds.push_back(start(line));
+    }
+    if (prgm.main) {
+        bounds.push_back(start(prgm.main->where().line()));
+    }
+    std::sort(bounds.begin(), bounds.end());
+    std::unordered_map<Defn_ptr,std::string_view> texts {};
+    for (auto [defn, at] : starts) {
+        std::size_t end = *std::upper_bound(bounds.begin(), bounds.end() - 1, at);
+        texts[defn] = text.substr(at, end - at);
+    }
+    return texts;
+}
+
+// keep(old,old_text,text)
+//
+// Puts each definition of the `old` program, of source `old_text`, that
+// can be kept into the program just parsed from `text`, in place of its
+// new copy. One can be kept if its text and line are just as they were,
+// and every definition it calls is kept too. (Its calls are bound to the
+// very definitions they call, so an edit to one has its callers checked
+// again.)
+//
+void DWISLPY::Driver::keep(Prgm_ptr old, std::string_view old_text, std::string_view text) {
+    std::unordered_map<Defn_ptr,std::string_view> was = def_texts(*old, old_text);
+    std::unordered_map<Defn_ptr,std::string_view> now = def_texts(*program, text);
+    std::unordered_set<Defn_ptr> kept {};
+    for (auto [name, defn] : program->defs) {
+        auto found = old->defs.find(name);
+        if (found == old->defs.end()) continue;
+        Defn_ptr prev = found->second;
+        if (prev->ready
+            && prev->where().line() == defn->where().line()
+            && was[prev] == now[defn]) {
+            kept.insert(prev);
+        }
+    }
+    for (bool changed = true; changed; ) {
+        changed = false;
+        for (auto it = kept.begin(); it != kept.end(); ) {
+            const std::vector<Defn_ptr>& callees = (*it)->callees;
+            if (std::all_of(callees.begin(), callees.end(),
+                            [&](Defn_ptr callee) { return kept.count(callee) > 0; })) {
+                it++;
+            } else {
+                it = kept.erase(it);
+                changed = true;
+            }
+        }
+    }
+    for (Defn_ptr prev : kept) {
+        program->defs[prev->name] = prev;
+    }
+}
+
+// dump
+//
+// Outputs the DwiSlpy program, either by depicting its AST, or by
+// a "pretty" version that mimics the original source code.
+//
+void DWISLPY::Driver::dump(bool pretty) {
+    if (pretty) {
+        program->output(std::cout);
+    } else {
+        program->dump();
+    }
+}
@@ -7,6 +7,7 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
 #include "dwislpy-bison.tab.hh"
 #include "dwislpy-util.hh"
 
@@ -14,12 +15,13 @@ namespace DWISLPY {
 
     class Lexer : public yyFlexLexer{
     public:
-        Lexer(std::istream *in, std::string fn) :
-            yyFlexLexer {in},
+        Lexer(Srce& src, std::string fn) :
+            yyFlexLexer {},
             src_name {fn},
             indents { }
         {
             indents.push_back(1); // Top-level indent is at column 1.
+            scan(src.scan_buffer(), src.text().size());
         }
 
         // Get rid of override virtual function warning
@@ -33,7 +35,7 @@ namespace DWISLPY {
 
         // Helper for Bison parsing.
         Locn locate(const DWISLPY::Parser::location_type& l);
-        
+
     private:
         // Tie-in to Bison.
         DWISLPY::Parser::semantic_type *yylval = nullptr;
@@ -44,11 +46,14 @@ namespace DWISLPY {
 
         using location_type = DWISLPY::Parser::location_type;
         
+        // Has the scanner take its characters from the source in place.
+        void scan(char* text, std::size_t size);
+
         // Used to issue tokens, update token locations, and determine indents.
-        void advance_by_text(const std::string txt, location_type* l);
+        void advance_by_text(std::string_view txt, location_type* l);
         void advance_by_char(char curr_char, location_type* l);
-        int indent_column(std::string text);
-        int issue(int tkn_typ, std::string txt, location_type* l);
+        int indent_column(std::string_view text);
+        int issue(int tkn_typ, std::string_view txt, location_type* l);
 
         // Terminate with an error.
         void bail(location_type* l, std::string msg);
@@ -36,6 +36,7 @@
 //
     
     #include <string>
+    #include <string_view>
     #include "dwislpy-util.hh"
     #include "dwislpy-flex.hh"
     
@@ -90,7 +91,7 @@
     // standalone. If instead the lexer is run by Bison, it will not
     // be null, and the location will be updated also.
     //
-    void DWISLPY::Lexer::advance_by_text(std::string txt, location_type* l) {
+    void DWISLPY::Lexer::advance_by_text(std::string_view txt, location_type* l) {
         l->step();
         for (char c: txt) {
             advance_by_char(c,l);
@@ -130,7 +131,7 @@
     // The method returns the column. It assumes that the string only
     // consists of tab and space characters.
     //
-    int DWISLPY::Lexer::indent_column(std::string txt) {
+    int DWISLPY::Lexer::indent_column(std::string_view txt) {
         int spaces = 0;
         for (char c: txt) {
             if (c == '\t') {
@@ -146,7 +147,7 @@
     //
     // Helper function that outputs a token to stdout.
     //
-    void debug_token(int tkn_typ, std::string txt, location_type* l) {
+    void debug_token(int tkn_typ, std::string_view txt, location_type* l) {
         if (tkn_typ == token::Token_EOLN) {
             std::cout << "[NEWLINE]";
         } else if (tkn_typ == token::Token_EOFL) {
@@ -179,7 +180,7 @@
     // the scanner rules. This can be particularly useful when trying
     // to debug the scanner.
     //
-    int DWISLPY::Lexer::issue(int tkn_typ, std::string txt,
+    int DWISLPY::Lexer::issue(int tkn_typ, std::string_view txt,
                               location_type *l) {
         advance_by_text(txt,l);
         // debug_token(tkn_typ,txt,l);
@@ -242,7 +243,7 @@ WSPC    {INDT}
     //
     // Handle some indentation at the start of a line.. 
     //
-    std::string indent { yytext };
+    std::string_view indent { yytext, static_cast<std::size_t>(yyleng) };
     advance_by_text(indent, loc);
 
     // Check this level versus the level on the stack.
@@ -271,7 +272,7 @@ WSPC    {INDT}
     //
     // Handle the start of a line with no indentation/
     //
-    unput(yytext[0]);
+    yyless(0);
     int level = 1;
     int last_level  = indents.back();
 
@@ -290,7 +291,7 @@ WSPC    {INDT}
     // Issue DEDENTs and pop the stack until this level
     // matches the level at the top of the stack.
     //
-    std::string indent { yytext };
+    std::string_view indent { yytext, static_cast<std::size_t>(yyleng) };
     int level = indent_column(indent);
     int last_level  = indents.back();
     
@@ -318,7 +319,7 @@ WSPC    {INDT}
     // Issue DEDENTs and pop the stack until we are at
     // the leftmost level.
     //
-    unput(yytext[0]);
+    yyless(0);
     int level = 1;
     int last_level = indents.back();
     if (last_level < level) {
@@ -346,9 +347,8 @@ WSPC    {INDT}
 
 <MID_LINE>\"[^\"\n\r\t]*\" {
     // Handle string literals.
-    std::string txt { yytext };
-    int len = txt.length();
-    std::string str = de_escape(txt.substr(1,len-2));
+    std::string_view txt { yytext, static_cast<std::size_t>(yyleng) };
+    std::string str = de_escape(std::string {txt.substr(1,txt.length()-2)});
     yylval->build<std::string>(str);
     return issue(token::Token_STRG,txt,loc);
 }
@@ -524,14 +524,16 @@ WSPC    {INDT}
 }
     
 <MID_LINE>{NAME} {
-    // Handle identifier names.
-    yylval->build<std::string>(yytext);
+    // Handle identifier names, as a view of the source.
+    yylval->build<std::string_view>(std::string_view { yytext, static_cast<std::size_t>(yyleng) });
     return issue(token::Token_NAME, yytext, loc);
 }
 
 <MID_LINE>{NMBR} {
-    // Handle integer literals.
-    yylval->build<int>(std::stoi(yytext));
+    // Handle integer literals, of any size.
+    Valu v {};
+    parse_int(yytext, v);
+    yylval->build<Valu>(std::move(v));
     return issue(token::Token_NMBR, yytext, loc);
 }
 
@@ -557,4 +559,29 @@ WSPC    {INDT}
     
 %%
 
-
+    //
+    // lx.scan(text,size)
+    //
+    // Has the scanner work on the `size` characters of `text` where they
+    // are, rather than copying them bit by bit into a buffer of its own.
+    // This does what flex's C `yy_scan_buffer` does, which its C++ class
+    // lacks: it hands flex a buffer that it must not fill or free. As
+    // there, `text` must be writable, and be followed by two NULs (see
+    // Srce), since flex marks the end of each token in place.
+    //
+    void DWISLPY::Lexer::scan(char* text, std::size_t size) {
+        yy_buffer_state* b = static_cast<yy_buffer_state*>(yyalloc(sizeof(yy_buffer_state)));
+        if (!b) {
+            YY_FATAL_ERROR("out of dynamic memory in scan()");
+        }
+        b->yy_buf_size = static_cast<int>(size);
+        b->yy_buf_pos = b->yy_ch_buf = text;
+        b->yy_is_our_buffer = 0;
+        b->yy_input_file = nullptr;
+        b->yy_n_chars = b->yy_buf_size;
+        b->yy_is_interactive = 0;
+        b->yy_at_bol = 1;
+        b->yy_fill_buffer = 0;
+        b->yy_buffer_status = YY_BUFFER_NEW;
+        yy_switch_to_buffer(b);
+    }
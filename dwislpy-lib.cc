@@ -0,0 +1,84 @@
+#include <string>
+#include <string_view>
+#include <memory>
+#include <cstdio>
+
+#include "dwislpy-util.hh"
+#include "dwislpy-main.hh"
+#include "dwislpy-lib.hh"
+
+//
+// dwislpy-lib.cc
+//
+// The programs of libdwislpy. See the header (.hh) file for details.
+//
+// A `Program` is a `Driver` that has done all of its work up to running
+// the program. The driver's methods for running it only read from it.
+//
+
+DWISLPY::Program::Program(std::unique_ptr<Driver> driver, const Options& opts) :
+    driver {std::move(driver)},
+    opts {opts}
+{ }
+
+DWISLPY::Program::~Program(void) = default;
+
+std::shared_ptr<const DWISLPY::Program>
+DWISLPY::Program::compile(const std::string& name, std::string_view text, const Options& opts) {
+    std::unique_ptr<Driver> driver {new Driver {name, text}};
+    Locs::Use use {driver->locations()};
+    driver->max_depth = opts.max_depth;
+    driver->memo = opts.memo;
+    driver->parse();
+    driver->check(opts.check_jobs);
+    driver->optimize(opts.level);
+    if (opts.vm) {
+        driver->compile();
+    }
+    return std::shared_ptr<const Program> {new Program {std::move(driver), opts}};
+}
+
+std::string DWISLPY::Program::run(std::string_view input, std::string& output) const {
+    Sink sink {output};
+    Sink::Use use_sink {sink};
+    Feed feed {input};
+    feed.prompts = opts.prompts;
+    Feed::Use use_feed {feed};
+    return run_here();
+}
+
+std::string DWISLPY::Program::run(int in_fd, std::FILE* out) const {
+    Sink sink {out};
+    Sink::Use use_sink {sink};
+    Feed feed {in_fd};
+    feed.prompts = opts.prompts;
+    Feed::Use use_feed {feed};
+    return run_here();
+}
+
+//
+// run_here()
+//
+// Runs the program with the sink and feed in use, giving the report of
+// any error it raises. This is the one place where a run's exceptions
+// are caught, those of any kind (see `failure`), so that none of them
+// reach the host.
+//
+std::string DWISLPY::Program::run_here(void) const {
+    Locs::Use use {driver->locations()};
+    try {
+        if (opts.vm) {
+            driver->run_vm();
+        } else {
+            driver->run();
+        }
+    } catch (const DwislpyError& se) {
+        Sink::in_use().flush();
+        return se.what();
+    } catch (const std::exception& e) {
+        Sink::in_use().flush();
+        return failure(e, driver->src_name).what();
+    }
+    Sink::in_use().flush();
+    return "";
+}
@@ -0,0 +1,77 @@
+#ifndef _DWISLPY_LIB_H
+#define _DWISLPY_LIB_H
+
+//
+// dwislpy-lib.hh
+//
+// The interface of libdwislpy (built by `make lib`), for running DWISLPY
+// programs from within a C++ program, such as a server, rather than as
+// a command of their own.
+//
+// A program is compiled once, from its source text, into a `Program`:
+// it is parsed, checked, optimized, and, if it is to run on the bytecode
+// machine, compiled to bytecode. That program is never changed after,
+// so it can be run any number of times, by any number of threads at
+// once. Each run has its own frames (and memo tables), and its own input
+// and output:
+//
+//   DWISLPY::Options opts {};
+//   opts.level = 2;
+//   std::shared_ptr<const DWISLPY::Program> prog =
+//       DWISLPY::Program::compile("hello.py", source, opts);
+//   std::string output;
+//   std::string error = prog->run("world\n", output);
+//
+// `compile` throws a DwislpyError for a program that does not parse or
+// does not check. `run` instead gives the report of a run-time error, as
+// the `dwislpy` command would, after the output made before it (which
+// includes any other exception, such as running out of memory); or it
+// gives an empty string if the program ran to its end. A run reads its
+// input from the given text or file descriptor, and writes its output to
+// the given string or file.
+//
+// The runs of a program share its literals, which is why their strings
+// are `share`d (see Strg). Runs are never tiered, since that would have
+// them change the heat of the nodes they run, and never profiled.
+//
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <cstdio>
+#include "dwislpy-util.hh"
+
+namespace DWISLPY {
+
+    class Driver; // See dwislpy-main.hh.
+
+    class Options {
+    public:
+        int level = 0;                 // As for -O.
+        bool vm = false;               // Whether to run on the bytecode machine.
+        unsigned int check_jobs = 1;   // As for --check-jobs.
+        unsigned int max_depth = 0;    // As for --max-depth.
+        bool memo = true;              // Unless as for --no-memo.
+        bool prompts = true;           // Unless as for --no-prompt.
+    };
+
+    class Program {
+    public:
+        static std::shared_ptr<const Program> compile(const std::string& name,
+                                                      std::string_view text,
+                                                      const Options& opts = {});
+        std::string run(std::string_view input, std::string& output) const;
+        std::string run(int in_fd, std::FILE* out) const;
+        Program(const Program&) = delete;
+        Program& operator=(const Program&) = delete;
+        ~Program(void);
+    private:
+        Program(std::unique_ptr<Driver> driver, const Options& opts);
+        std::string run_here(void) const;
+        std::unique_ptr<Driver> driver;
+        Options opts;
+    };
+
+}
+
+#endif
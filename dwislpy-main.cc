@@ -1,17 +1,40 @@
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <cstring>
+#include <cstdlib>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <unordered_map>
+#include <filesystem>
+#include <csignal>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 #include "dwislpy-ast.hh"
 #include "dwislpy-flex.hh"
 #include "dwislpy-bison.tab.hh"
 #include "dwislpy-util.hh"
+#include "dwislpy-vm.hh"
+#include "dwislpy-cache.hh"
+#include "dwislpy-stats.hh"
 #include "dwislpy-main.hh"
 
 //
 // dwislpy - a DWISLPY ("Def While If + Straight-Line PYthon") interpreter.
 //
-// Usage: ./dwislpy [--test] [--dump [--pretty]] <DWISLPY source file name>
+// Usage: ./dwislpy [--test] [--vm] [--tiered] [--line-buffered] [--no-prompt] [--slurp-input] [--emit-c] [--cache-dir=<dir>] [--no-cache] [--check-jobs=<n>] [--max-depth=<n>] [--no-memo] [--profile[=<name>]] [--time-phases] [--stats] [--stream] [-O0|-O1|-O2|-O3] [--dump [--pretty]] <DWISLPY source file name>
+//        ./dwislpy --batch [--jobs=<n>] [flags] <DWISLPY source file names, or @list>
+//        ./dwislpy --serve=<socket> [--vm|--tiered] [-O0|-O1|-O2|-O3] [flags]
+//        ./dwislpy --connect=<socket> <DWISLPY source file name>
 //
 // This implements a Unix command for processing a DWISLPY program.  By
 // default, it executes a DWISLPY program. There are command-line flags
@@ -23,11 +46,105 @@
 //
 //    --test - give a simple ERROR message when an error occurs.
 //
+//    --vm - run the program on the bytecode machine instead of the
+//           tree-walking interpreter. With --dump, list the bytecode.
+//
+//    --tiered - run the program on the tree-walking interpreter, but hand
+//           the definitions and loops that get run a lot over to the
+//           bytecode machine.
+//
+//    --line-buffered - write out each line the program prints as soon
+//           as it ends, rather than saving up its output.
+//
+//    --no-prompt - don't output the prompts of `input`, for batch runs.
+//
+//    --slurp-input - read all of the input (or map it, for a file) before
+//           running, rather than a chunk at a time.
+//
+//    --emit-c - instead of running the checked program, output it as a
+//           C program, to be compiled along with runtime/dwislpy-rt.c.
+//
+//    --cache-dir=<dir> - where --vm keeps the bytecode of the programs
+//           it has compiled, so that running the same source again skips
+//           straight to running it (see dwislpy-cache.hh). The default
+//           is $XDG_CACHE_HOME/dwislpy, or else ~/.cache/dwislpy.
+//
+//    --no-cache - compile the program from its source every time.
+//
+//    --check-jobs=<n> - check the bodies of the program's definitions on
+//           n threads at once. Errors are still reported in source order.
+//
+//    --max-depth=<n> - the most calls that can be in progress at once.
+//           The default is 1000 for the interpreter, which nests C++
+//           calls for each, and 1000000 for the bytecode machine, which
+//           keeps its frames on the heap. A `return f(...)` run by the
+//           machine reuses the frame of its caller, and so doesn't count
+//           as going any deeper. Only the machine takes large depths:
+//           the interpreter (including that of --tiered) also stops at
+//           what its C++ stack can hold, typically several thousand
+//           calls, whatever the n. Either way, going deeper is a
+//           run-time error.
+//
+//    --no-memo - make every call the interpreter runs, rather than give
+//           a call of a pure definition the result it gave before for
+//           the same arguments (see Defn::memoize).
+//
+//    --profile, --profile=<name> - run the program on the interpreter,
+//           counting the statements and calls it makes and sampling
+//           where its time goes. This writes the source annotated with
+//           these to <name>.prof, and the time in each stack of calls
+//           to <name>.folded, for flame graph tools. The default name
+//           is the source file's.
+//
+//    --time-phases - report the time taken to load the program from the
+//           cache, parse, check, optimize, compile, and run it (those
+//           it does) on the error stream once it is done.
+//
+//    --stats - report counts of what the program did as it ran (see
+//           dwislpy-stats.hh) on the error stream once it is done. These
+//           are only kept by a dwislpy built with `make STATS=1`.
+//
+//    --batch - run every program named (or listed, one per line, in the
+//           file named by an argument @list) in this one process, on a
+//           pool of --jobs=<n> threads (by default, one per core). Each
+//           program's output is collected, then written out in order
+//           under a header line; a program reads the file of its name
+//           with ".in" added as its input. Not for --dump or --emit-c.
+//
+//    --serve=<socket> - listen on a Unix socket, running each program that
+//           is asked for there (see `serve`), and keeping it parsed and
+//           checked in between. When its file changes, only the
+//           definitions that were edited, or that call one that was, are
+//           checked again. Each run uses the server's flags.
+//
+//    --connect=<socket> - have the server on that socket run the named
+//           program, with this command's input and output as its own.
+//
+//    --stream - run each statement of the main script as soon as it has
+//           been parsed, and then forget it, rather than parse and check
+//           all of the program before running any of it. Its definitions
+//           are still all checked first. This starts a long script's
+//           output sooner, and holds only one of its statements at a
+//           time, but an error later in the script is only reported
+//           once the statements before it have run. Only for the
+//           interpreter, so not with --vm, --tiered, --profile, --dump,
+//           or --emit-c.
+//
+//    -O0, -O1, -O2, -O3 - the level of optimization applied to the checked
+//           program before it runs (see dwislpy-opt.cc). The default
+//           is -O0. With --dump, check and optimize the program first,
+//           so that what gets dumped is the optimized program.
+//
 // The code is heavily reliant upon:
 //
 // * dwislpy-ast.{cc,hh} - defines the AST for DWISLPY programs
 // * dwislpy-flex.{cc,hh} - converts the source into a feed of tokens
 // * dwislpy-bison.{cc,hh} - parses a DWISLPY token stream
+// * dwislpy-opt.cc - simplifies checked DWISLPY programs
+// * dwislpy-vm.{cc,hh} - compiles and runs DWISLPY bytecode
+// * dwislpy-cgen.{cc,hh} - compiles DWISLPY programs to C
+// * dwislpy-cache.{cc,hh} - saves and loads compiled bytecode
+// * dwislpy-lib.{cc,hh} - runs DWISLPY programs within other programs
 //
 // The latter two work in tandem as a Flex/Bison-based lexer/parser duo.
 //
@@ -38,7 +155,8 @@
 //
 // The interpreter is housed as a DWISLPY::Driver object, which also
 // houses the lexer and parser (each written using Flex and Bison).
-// See the .hh file for details on it, and see the methods below.
+// See the .hh file for details on it, and dwislpy-driver.cc for its
+// methods.
 //
 // * * * * * 
 //
@@ -52,6 +170,27 @@ bool check_flag(int argc, char** argv, std::string flag) {
     return false;
 }
 
+int extract_level(int argc, char** argv) {
+    int level = -1;
+    for (int i=1; i<argc; i++) {
+        if (strcmp("-O0",argv[i]) == 0) level = 0;
+        if (strcmp("-O1",argv[i]) == 0) level = 1;
+        if (strcmp("-O2",argv[i]) == 0) level = 2;
+        if (strcmp("-O3",argv[i]) == 0) level = 3;
+    }
+    return level;
+}
+
+std::string extract_option(int argc, char** argv, std::string prefix) {
+    std::string value = "";
+    for (int i=1; i<argc; i++) {
+        if (strncmp(prefix.c_str(),argv[i],prefix.size()) == 0) {
+            value = argv[i] + prefix.size();
+        }
+    }
+    return value;
+}
+
 char* extract_filename(int argc, char** argv) {
     for (int i=1; i<argc; i++) {
         if (argv[i][0] != '-') return argv[i];
@@ -59,71 +198,450 @@ char* extract_filename(int argc, char** argv) {
     return nullptr;
 }
 
-// * * * * *
 //
-// DWISLPY::Driver methods.
+// extract_filenames - every file named on the command line, for `--batch`.
+// An argument "@list" names a file that lists more of them, one per line.
 //
-// This class just houses the components of the DWISLPY interpreter.
-// We wrote it this way just to prevent some deallocation errors
-// due to sharing pointers in our interfacing with Flex/Bison, programs
-// built in a more permissive error (and originally for C).
+std::vector<std::string> extract_filenames(int argc, char** argv) {
+    std::vector<std::string> filenames {};
+    for (int i=1; i<argc; i++) {
+        if (argv[i][0] == '@') {
+            std::ifstream list {argv[i] + 1};
+            std::string line;
+            while (std::getline(list, line)) {
+                if (!line.empty()) filenames.push_back(line);
+            }
+        } else if (argv[i][0] != '-') {
+            filenames.push_back(argv[i]);
+        }
+    }
+    return filenames;
+}
+
+// * * * * * 
+//
+// Optn - what the command line asks to be done with each program.
+//
+class Optn {
+public:
+    bool dump;
+    bool pretty;
+    bool testing;
+    bool vm;
+    bool tiered;
+    bool emit_c;
+    bool slurp;
+    bool caching;
+    int level;
+    unsigned int check_jobs;
+    unsigned int max_depth;
+    bool memo;
+    bool profiling;
+    std::string profile; // Where to write the profile, if not by the source.
+    std::string cache_dir;
+    bool timing;
+    bool stats;
+    bool streaming;
+};
+
+//
+// Phss - the time taken by each phase of processing a program, kept
+// for --time-phases. Each `start` ends the phase before it.
+//
+class Phss {
+public:
+    Phss(bool on) : on {on} { }
+    void start(const char* name) {
+        if (!on) return;
+        stop();
+        current = name;
+        began = std::chrono::steady_clock::now();
+    }
+    void stop(void) {
+        if (!on || !current) return;
+        std::chrono::duration<double,std::milli> ms = std::chrono::steady_clock::now() - began;
+        times.emplace_back(current, ms.count());
+        current = nullptr;
+    }
+    void report(std::ostream& os) const {
+        for (const auto& [name, ms] : times) {
+            os << "time " << name << " " << std::fixed << std::setprecision(3)
+               << ms << " ms" << std::endl;
+        }
+    }
+private:
+    bool on;
+    const char* current = nullptr;
+    std::chrono::steady_clock::time_point began;
+    std::vector<std::pair<const char*,double>> times;
+};
+
+//
+// report(se,opts,errs)
+//
+// Reports the error `se` raised by a program, after what the program
+// printed before it failed.
 //
+void report(const DwislpyError& se, const Optn& opts, std::ostream& errs) {
+    Sink& out = Sink::in_use();
+    out.flush();
 
-DWISLPY::Driver::Driver(std::string filename) :
-    src_name {filename}
-{
-    src_stream = istream_ptr { new std::ifstream { src_name } };
+    if (opts.testing) {
+        //
+        // If --test flag then just give "ERROR" message.
+        //
+        out.put(std::string {"ERROR"});
+        out.end();
+        out.flush();
+    } else {
+        //
+        // Otherwise, report the error.
+        //
+        errs << se.what() << std::endl;
+    }
 }
 
-// parse
 //
-// Checks the file's stream, builds the lexer for it, then parses the
-// file's contents. The parser sets the `prgm` AST using the `set`
-// method.
+// process(filename,opts,errs)
+//
+// Does what `opts` asks with the DWISLPY program in the named file. Its
+// output goes to the sink in use, and the report of any error it raises
+// goes to `errs`.
 //
-void DWISLPY::Driver::parse(void) {
-    if (src_stream->fail()) {
-        Locn locn {src_name};
-        std::string mesg = "Unable to open file. Does the file exist?";
-        throw DwislpyError {locn, mesg};
+void process(const std::string& filename, const Optn& opts, std::ostream& errs) {
+    DWISLPY::Driver dwislpy { filename };
+    Locs::Use use {dwislpy.locations()};
+    dwislpy.max_depth = opts.max_depth;
+    dwislpy.memo = opts.memo;
+    //
+    // Catch DWISLPY errors, and report any other exception as one.
+    //
+    Phss phases {opts.timing};
+    Stats stats {};
+    std::unique_ptr<Stats::Use> use_stats {};
+    try {
+        
+        //
+        // Parse, unless the compiled program is in the cache, or is to
+        // be parsed as it runs.
+        //
+        bool cached = false;
+        if (opts.caching) {
+            phases.start("cache load");
+            cached = dwislpy.load_cache(opts.cache_dir,opts.level);
+        }
+        if (!cached && !opts.streaming) {
+            phases.start("parse");
+            dwislpy.parse();
+        }
+        if (opts.slurp) {
+            Feed::in_use().slurp();
+        }
+
+        //
+        // Check and optimize it, unless it is only to be dumped as parsed.
+        //
+        bool as_parsed = opts.dump && !opts.vm && opts.level < 0;
+        if (!cached && !as_parsed && !opts.streaming) {
+            phases.start("check");
+            dwislpy.check(opts.check_jobs);
+            phases.start("optimize");
+            dwislpy.optimize(opts.level);
+        }
+
+        //
+        // Either dump or run the code.
+        //
+        if (opts.stats) {
+            use_stats.reset(new Stats::Use {stats});
+        }
+        if (cached) {
+            phases.start("run");
+            dwislpy.run_vm();
+        } else if (opts.streaming) {
+            phases.start("stream");
+            dwislpy.stream(opts.check_jobs, opts.level);
+        } else if (opts.emit_c) {
+            phases.start("emit");
+            dwislpy.emit_c();
+        } else if (opts.dump && opts.vm) {
+            phases.start("compile");
+            dwislpy.compile();
+            phases.start("dump");
+            dwislpy.dump_vm();
+        } else if (opts.dump) {
+            phases.start("dump");
+            dwislpy.dump(opts.pretty);
+        } else if (opts.profiling) {
+            phases.start("run");
+            dwislpy.run_profiled(opts.profile.empty() ? filename : opts.profile);
+        } else if (opts.vm) {
+            phases.start("compile");
+            dwislpy.compile();
+            dwislpy.save_cache();
+            phases.start("run");
+            dwislpy.run_vm();
+        } else if (opts.tiered) {
+            phases.start("run");
+            dwislpy.run_tiered();
+        } else {
+            phases.start("run");
+            dwislpy.run();
+        }
+        phases.stop();
+        
+    } catch (const DwislpyError& se) {
+        report(se, opts, errs);
+        phases.stop();
+    } catch (const std::exception& e) {
+        report(failure(e, filename), opts, errs);
+        phases.stop();
+    }
+    phases.report(errs);
+    if (opts.stats) {
+        stats.report(errs);
     }
-    lexer = Lexer_ptr { new DWISLPY::Lexer { src_stream.get(), src_name } };
-    DWISLPY::Lexer& lexer_local = *lexer;
-    parser = Parser_ptr { new DWISLPY::Parser { lexer_local, *this } };
-    parser->parse();
 }
 
-// run
 //
-// Runs the DwiSlpy program.
+// batch(filenames,opts,jobs)
+//
+// Runs each of the named programs, `jobs` at a time, for `--batch`. Each
+// runs on a thread of its own with its own sink, which collects all of
+// its output, and its own feed, which reads the file named as the
+// program but with ".in" added, if there is one. Once they have all
+// finished, the output of each is written out in turn, headed by its
+// name, followed by the report of any error it raised.
 //
-void DWISLPY::Driver::run(void) {
-    program->run();
+void batch(const std::vector<std::string>& filenames, const Optn& opts, unsigned int jobs) {
+    class Rslt {
+    public:
+        std::string output;
+        std::ostringstream errs;
+    };
+    std::vector<Rslt> results(filenames.size());
+    std::atomic<std::size_t> next {0};
+    auto work = [&](void) {
+        for (std::size_t i = next++; i < filenames.size(); i = next++) {
+            int fd = open((filenames[i] + ".in").c_str(), O_RDONLY);
+            {
+                Sink sink {results[i].output};
+                Sink::Use use_sink {sink};
+                Feed feed {fd};
+                feed.prompts = Feed::in.prompts;
+                Feed::Use use_feed {feed};
+                process(filenames[i], opts, results[i].errs);
+            }
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned int j = 0; j < jobs && j < filenames.size(); j++) {
+        workers.emplace_back(work);
+    }
+    for (std::thread& t : workers) {
+        t.join();
+    }
+    for (std::size_t i = 0; i < filenames.size(); i++) {
+        std::string head = "==> " + filenames[i] + " <==";
+        Sink::out.put(head);
+        Sink::out.end();
+        Sink::out.put(results[i].output);
+        Sink::out.flush();
+        std::cerr << results[i].errs.str();
+    }
 }
 
-// run
 //
-// Runs the DwiSlpy program.
+// send_all(fd,bytes,n)
+//
+// Writes all `n` bytes to `fd`, giving whether that worked.
 //
-void DWISLPY::Driver::check(void) {
-    program->chck();
+static bool send_all(int fd, const char* bytes, std::size_t n) {
+    while (n > 0) {
+        ssize_t sent = write(fd, bytes, n);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        bytes += sent;
+        n -= sent;
+    }
+    return true;
 }
 
-// dump
 //
-// Outputs the DwiSlpy program, either by depicting its AST, or by
-// a "pretty" version that mimics the original source code.
+// Srvd - a program loaded by `--serve`, kept for as long as it serves.
 //
-void DWISLPY::Driver::dump(bool pretty) {
-    if (pretty) {
-        program->output(std::cout);
-    } else {
-        program->dump();
+typedef std::unordered_map<std::string,std::unique_ptr<DWISLPY::Driver>> Srvd;
+
+//
+// respond(loaded,filename,opts,errs)
+//
+// Runs the DWISLPY program in the named file for `--serve`, first
+// loading it if it isn't among those `loaded`, or else bringing it up to
+// date with its file. Its output goes to the sink in use, and the report
+// of any error goes to `errs`. That includes any other exception, such
+// as running out of memory, so that no one program stops the server.
+//
+static void respond(Srvd& loaded, const std::string& filename, const Optn& opts, std::ostream& errs) {
+    std::unique_ptr<DWISLPY::Driver>& dwislpy = loaded[filename];
+    if (!dwislpy) {
+        dwislpy.reset(new DWISLPY::Driver {filename});
+        dwislpy->max_depth = opts.max_depth;
+        dwislpy->memo = opts.memo;
+    }
+    Locs::Use use {dwislpy->locations()};
+    Phss phases {opts.timing};
+    try {
+        phases.start("refresh");
+        bool changed = dwislpy->refresh(opts.check_jobs, opts.level);
+        if (opts.vm) {
+            if (changed) {
+                phases.start("compile");
+                dwislpy->compile();
+            }
+            phases.start("run");
+            dwislpy->run_vm();
+        } else if (opts.tiered) {
+            phases.start("run");
+            dwislpy->run_tiered();
+        } else {
+            phases.start("run");
+            dwislpy->run();
+        }
+        phases.stop();
+    } catch (const DwislpyError& se) {
+        report(se, opts, errs);
+        phases.stop();
+    } catch (const std::exception& e) {
+        report(failure(e, filename), opts, errs);
+        phases.stop();
+    }
+    phases.report(errs);
+}
+
+//
+// serve(socket_name,opts)
+//
+// Listens on the Unix socket of the given name, for `--serve`, and runs
+// a program for each connection to it, one at a time. A connection sends
+// the line "run <path>", naming the program's source file, and then the
+// program's input. It is sent back the program's output, followed by
+// the report of any error, and then closed.
+//
+// Each program stays loaded between runs, checked and optimized, and is
+// only refreshed before each (see Driver::refresh). The -O level and the
+// other options given to the server apply to every run.
+//
+void serve(const std::string& socket_name, const Optn& opts) {
+    sockaddr_un addr {};
+    addr.sun_family = AF_UNIX;
+    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0 || socket_name.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Unable to serve on " << socket_name << "." << std::endl;
+        return;
+    }
+    std::memcpy(addr.sun_path, socket_name.c_str(), socket_name.size());
+    unlink(socket_name.c_str());
+    if (bind(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+        || listen(sock, 16) != 0) {
+        std::cerr << "Unable to serve on " << socket_name << ": "
+                  << std::strerror(errno) << std::endl;
+        close(sock);
+        return;
+    }
+    std::signal(SIGPIPE, SIG_IGN); // A client that leaves early is just unheard.
+    Srvd loaded {};
+    for (;;) {
+        int conn = accept(sock, nullptr, nullptr);
+        if (conn < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        //
+        // Read the request a byte at a time, so as to leave the program's
+        // input for its feed.
+        //
+        std::string asked {};
+        char c;
+        while (read(conn, &c, 1) == 1 && c != '\n') {
+            asked.push_back(c);
+        }
+        std::FILE* fp = fdopen(dup(conn), "w");
+        if (fp) {
+            Sink sink {fp};
+            sink.line_buffered = Sink::out.line_buffered;
+            Sink::Use use_sink {sink};
+            Feed feed {conn};
+            feed.prompts = Feed::in.prompts;
+            Feed::Use use_feed {feed};
+            std::ostringstream errs {};
+            if (asked.compare(0, 4, "run ") == 0) {
+                respond(loaded, asked.substr(4), opts, errs);
+            } else {
+                errs << "Unknown request \"" << asked << "\"." << std::endl;
+            }
+            sink.put(errs.str());
+            sink.flush();
+        }
+        if (fp) {
+            std::fclose(fp);
+        }
+        close(conn);
     }
+    close(sock);
 }
 
+//
+// request(socket_name,filename)
+//
+// Has the server listening on the named socket run the named program,
+// for `--connect`. This process's input is sent on as the program's, and
+// what the server sends back is written out.
+//
+int request(const std::string& socket_name, const std::string& filename) {
+    sockaddr_un addr {};
+    addr.sun_family = AF_UNIX;
+    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0 || socket_name.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Unable to connect to " << socket_name << "." << std::endl;
+        return 1;
+    }
+    std::memcpy(addr.sun_path, socket_name.c_str(), socket_name.size());
+    if (connect(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::cerr << "Unable to connect to " << socket_name << ": "
+                  << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+    std::string line = "run " + std::filesystem::absolute(filename).string() + "\n";
+    if (!send_all(sock, line.data(), line.size())) {
+        std::cerr << "Unable to send to " << socket_name << "." << std::endl;
+        return 1;
+    }
+    //
+    // The program may finish without reading all of its input, so the
+    // thread sending it is left behind rather than waited for.
+    //
+    std::thread {[sock](void) {
+        char bytes[4096];
+        for (;;) {
+            ssize_t n = read(0, bytes, sizeof(bytes));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0 || !send_all(sock, bytes, n)) break;
+        }
+        shutdown(sock, SHUT_WR);
+    }}.detach();
+    char bytes[4096];
+    for (;;) {
+        ssize_t n = read(sock, bytes, sizeof(bytes));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0 || !send_all(1, bytes, n)) break;
+    }
+    return 0;
+}
 
-// * * * * * 
 //
 // main - the DWISLPY interpreter
 //
@@ -132,57 +650,81 @@ int main(int argc, char** argv) {
     //
     // Process the command-line, including any flags.
     //
-    bool dump   = check_flag(argc,argv,"--dump");
-    bool pretty = false;
-    if (dump) {
-        pretty = check_flag(argc,argv,"--pretty");
+    Optn opts {};
+    opts.dump    = check_flag(argc,argv,"--dump");
+    opts.pretty  = false;
+    if (opts.dump) {
+        opts.pretty = check_flag(argc,argv,"--pretty");
     }
-    bool testing   = check_flag(argc,argv,"--test");
+    opts.testing = check_flag(argc,argv,"--test");
+    opts.vm      = check_flag(argc,argv,"--vm");
+    opts.tiered  = check_flag(argc,argv,"--tiered");
+    opts.emit_c  = check_flag(argc,argv,"--emit-c");
+    Sink::out.line_buffered = check_flag(argc,argv,"--line-buffered");
+    Feed::in.prompts = !check_flag(argc,argv,"--no-prompt");
+    opts.slurp   = check_flag(argc,argv,"--slurp-input");
+    opts.level   = extract_level(argc,argv);
+    opts.max_depth = 0;
+    std::string max_depth = extract_option(argc,argv,"--max-depth=");
+    if (!max_depth.empty()) {
+        opts.max_depth = std::max(std::atoi(max_depth.c_str()),1);
+    }
+    opts.memo = !check_flag(argc,argv,"--no-memo");
+    opts.timing = check_flag(argc,argv,"--time-phases");
+    opts.stats = check_flag(argc,argv,"--stats");
+    opts.check_jobs = 1;
+    std::string check_jobs = extract_option(argc,argv,"--check-jobs=");
+    if (!check_jobs.empty()) {
+        opts.check_jobs = std::max(std::atoi(check_jobs.c_str()),1);
+    }
+    opts.profile = extract_option(argc,argv,"--profile=");
+    opts.profiling = check_flag(argc,argv,"--profile") || !opts.profile.empty();
+    opts.streaming = check_flag(argc,argv,"--stream") && !opts.vm && !opts.tiered
+        && !opts.profiling && !opts.dump && !opts.emit_c;
+    opts.caching = opts.vm && !opts.dump && !opts.emit_c && !opts.profiling
+        && !check_flag(argc,argv,"--no-cache");
+    opts.cache_dir = extract_option(argc,argv,"--cache-dir=");
+    if (opts.cache_dir.empty()) {
+        opts.cache_dir = cache_home();
+    }
+    bool batching = check_flag(argc,argv,"--batch") && !opts.dump && !opts.emit_c;
+    std::string serving = extract_option(argc,argv,"--serve=");
+    std::string server = extract_option(argc,argv,"--connect=");
     char* filename = extract_filename(argc,argv);
     
-    if (filename) {
-        DWISLPY::Driver dwislpy { filename };
-        //
-        // Catch DWISLPY errors.
-        //
-        try {
-            
-            //
-            // Parse.
-            //
-            dwislpy.parse();
-
-            //
-            // Either dump or run the parsed code.
-            //
-            if (dump) {
-                dwislpy.dump(pretty);
-            } else {
-                dwislpy.check();
-                dwislpy.run();
-            }
-            
-        } catch (DwislpyError se) {
-            
-            if (testing) {
-                //
-                // If --test flag then just give "ERROR" message.
-                //
-                std::cout << "ERROR" << std::endl;
-            } else {
-                //
-                // Otherwise, report the error.
-                //
-                std::cerr << se.what() << std::endl;
-            }
-        } 
+    if (!serving.empty()) {
+        serve(serving, opts);
+    } else if (!server.empty() && filename) {
+        return request(server, filename);
+    } else if (batching) {
+        std::vector<std::string> filenames = extract_filenames(argc,argv);
+        unsigned int jobs = std::thread::hardware_concurrency();
+        std::string given = extract_option(argc,argv,"--jobs=");
+        if (!given.empty()) {
+            jobs = std::atoi(given.c_str());
+        }
+        batch(filenames, opts, std::max(jobs,1u));
+    } else if (filename) {
+        process(filename, opts, std::cerr);
     } else {
         //
         // Give some command line help.
         //
         std::cerr << "usage: "
                   << argv[0]
-                  << " [--dump [--pretty]] [--test] file"
+                  << " [--dump [--pretty]] [--test] [--vm] [--tiered] [--line-buffered] [--no-prompt] [--slurp-input] [--emit-c] [--cache-dir=<dir>] [--no-cache] [--check-jobs=<n>] [--max-depth=<n>] [--no-memo] [--profile[=<name>]] [--time-phases] [--stats] [--stream] [-O0|-O1|-O2|-O3] file"
+                  << std::endl
+                  << "       "
+                  << argv[0]
+                  << " --batch [--jobs=<n>] [options] file... | @list"
+                  << std::endl
+                  << "       "
+                  << argv[0]
+                  << " --serve=<socket> [options]"
+                  << std::endl
+                  << "       "
+                  << argv[0]
+                  << " --connect=<socket> file"
                   << std::endl;
     }
 }
@@ -23,14 +23,17 @@
 //
 
 #include <string>
-#include <istream>
+#include <string_view>
+#include <vector>
+#include <memory>
 
 #include "dwislpy-flex.hh"
 #include "dwislpy-bison.tab.hh"
+#include "dwislpy-vm.hh"
 
 typedef std::shared_ptr<DWISLPY::Lexer> Lexer_ptr;
 typedef std::shared_ptr<DWISLPY::Parser> Parser_ptr;
-typedef std::shared_ptr<std::istream> istream_ptr;
+typedef std::shared_ptr<Bytc> Bytc_ptr;
 
 /*
  * class DWISLPY::Driver
@@ -40,13 +43,32 @@ typedef std::shared_ptr<std::istream> istream_ptr;
  *
  * The methods it provides are:
  *   parse - runs the parser, building the AST
- *   set - sets the AST that results from a parse
+ *   set - sets the AST that results from a parse: first the program,
+ *         once its definitions are parsed, and then its main script
+ *   step - when streaming, runs a statement of the main script as soon
+ *          as it is parsed, giving whether it did
  *   run - executes the parsed DwiDlpy program
+ *   stream - parses and runs the program at once, a statement at a time
+ *   check - checks the parsed program, its definitions on `jobs` threads
+ *   optimize - simplifies and specializes the checked program
  *   dump - (pretty) prints the AST
+ *   compile - lowers the checked AST into bytecode
+ *   run_vm - executes that bytecode
+ *   run_tiered - executes on the interpreter, moving hot code to the VM
+ *   dump_vm - lists that bytecode
+ *   emit_c - outputs the checked program as C
+ *   load_cache - looks for the bytecode of this source in a cache
+ *                directory, giving whether it was found
+ *   save_cache - saves the compiled bytecode where `load_cache` looked
+ *   refresh - for `--serve`, brings the checked and optimized program up
+ *             to date with its source file, giving whether it changed
+ *   locations - the table of source locations, which whatever uses
+ *             the driver should put in use (with a `Locs::Use`)
  *
- * Note that the constructor attempts to create a stream attached to
- * the provided name of the DwiSlpy source file. However, the success
- * of that operation is only checked when `parse` is called.
+ * Note that the constructor attempts to open (and map) the DwiSlpy
+ * source file of the provided name. However, the success of that
+ * operation is only checked when `parse` is called. The other
+ * constructor takes the source text itself, and the name to give it.
  */
 
 namespace DWISLPY {
@@ -54,17 +76,50 @@ namespace DWISLPY {
     class Driver {
     public:
         Driver(std::string filename);
+        Driver(std::string name, std::string_view text);
         void parse(void);
         void run(void);
-        void check(void);
+        void stream(unsigned int jobs, int level);
+        void check(unsigned int jobs = 1);
+        void optimize(int level);
         void dump(bool pretty);
-        void set(Prgm_ptr prgm) { program = prgm; }
+        void compile(void);
+        void run_vm(void);
+        void run_tiered(void);
+        void run_profiled(const std::string& name);
+        void dump_vm(void);
+        void emit_c(void);
+        bool load_cache(const std::string& dir, int level);
+        void save_cache(void);
+        bool refresh(unsigned int jobs, int level);
+        Locs& locations(void) { return locs; }
+        void set(Prgm_ptr prgm);
+        void set(Blck_ptr main) { program->main = main; }
+        bool step(Stmt_ptr stmt);
         std::string src_name;
+        unsigned int max_depth = 0; // The deepest calls can nest (0 for the default).
+        bool memo = true; // Whether the interpreter memoizes pure calls.
     private:
-        istream_ptr src_stream = nullptr;
+        Locs        locs;   // The source locations of this program.
+        Arena       arena;  // Holds the nodes of `program`.
+        Srce        src;    // The text of the source file.
+        std::vector<std::unique_ptr<Arena>> reparsed; // Hold those of each `refresh`.
+        std::string served; // The text `program` was last refreshed from.
         Prgm_ptr    program = nullptr;
+        Bytc_ptr    bytecode = nullptr;
+        std::string cache_file;     // Set by `load_cache`, along with:
+        std::string cache_opts;
         Lexer_ptr   lexer = nullptr;
         Parser_ptr  parser  = nullptr;
+        bool        streaming = false;  // Set by `stream`, along with:
+        unsigned int stream_jobs = 1;
+        int         stream_level = 0;
+        Arena       script;             // Holds the nodes of the statement being streamed,
+        std::size_t located = 0;        // which made the locations from this one on.
+        Stck        stck;               // The frames the streamed statements run in.
+        bool        stopped = false;    // Whether one of them returned.
+        Arena& nodes(void) { return reparsed.empty() ? arena : *reparsed.back(); }
+        void keep(Prgm_ptr old, std::string_view old_text, std::string_view text);
     };
 
 }
@@ -0,0 +1,889 @@
+#include <string>
+#include <vector>
+#include <memory>
+#include <initializer_list>
+#include <unordered_map>
+#include <functional>
+
+#include "dwislpy-ast.hh"
+#include "dwislpy-check.hh"
+#include "dwislpy-util.hh"
+
+//
+// dwislpy-opt.cc
+//
+// The DWISLPY optimizer. It rewrites a checked program into a simpler
+// one that behaves the same. It is run by the driver between `chck` and
+// `spcl`, at the level chosen by -O on the command line:
+//
+//   -O0 - no changes (the default)
+//
+//   -O1 - fold operations on literals into literals (e.g. `60 * 60 * 24`),
+//         resolve `if`s, inline `if`s, `while`s, and `repeat`s whose
+//         conditions are literals, short-circuit `and`/`or` on a literal
+//         left operand, drop `pass` statements (apart from one kept to
+//         stand for an otherwise empty block), and drop the statements
+//         that follow a `return` within a block
+//
+//   -O2 - also apply algebraic identities, e.g. `x + 0`, `s * 1`,
+//         `not not b`, `not (a < b)`, `b and True`
+//
+//   -O3 - also inline calls of small functions (see `inline_call`), and
+//         hoist, reduce, and count loops (see `optm_loop`)
+//
+// An identity that would discard an operand is only applied when that
+// operand is a variable or a literal, so that no call or input is lost.
+// An operation on literals that fails (a division by 0, say) is left
+// alone, so that its error is still reported if the program runs it.
+//
+// The work is spread over the AST nodes as methods `optm`, just as
+// `chck` is spread over them in dwislpy-check.cc. A statement's `optm`
+// gives the statements that should replace it in its block (none, to
+// remove it). An expression's `optm` gives the expression that should
+// replace it. Each simplifies its own parts first.
+//
+// Any variable introduced in a branch that gets inlined into the
+// enclosing block keeps its frame slot, since `chck` has resolved these
+// already. The `type` recorded on each expression is kept, as `spcl`
+// relies on it.
+//
+
+//
+// The longest string that a literal `str * int` is folded into. Longer
+// results are left to be built at run time (if at all).
+//
+static const std::size_t FOLD_STR_MAX = 1 << 12;
+
+static Ltrl_ptr as_ltrl(const Expn_ptr& e) {
+    return dynamic_cast<Ltrl*>(e);
+}
+
+static bool is_int_ltrl(const Expn_ptr& e, int n) {
+    Ltrl_ptr l = as_ltrl(e);
+    return l && std::holds_alternative<Word>(l->valu) && std::get<Word>(l->valu) == n;
+}
+
+static bool is_bool_ltrl(const Expn_ptr& e, bool b) {
+    Ltrl_ptr l = as_ltrl(e);
+    return l && std::holds_alternative<bool>(l->valu) && std::get<bool>(l->valu) == b;
+}
+
+static bool is_empty_str_ltrl(const Expn_ptr& e) {
+    Ltrl_ptr l = as_ltrl(e);
+    return l && std::holds_alternative<Strg>(l->valu) && std::get<Strg>(l->valu).size() == 0;
+}
+
+//
+// is_pure(e)
+//
+// Whether evaluating `e` can be skipped without changing what the
+// program does.
+//
+static bool is_pure(const Expn_ptr& e) {
+    return as_ltrl(e) || dynamic_cast<Lkup*>(e);
+}
+
+//
+// ltrl(v,e)
+//
+// Builds a literal with value `v` to stand in place of the expression `e`.
+//
+static Expn_ptr ltrl(Valu v, const Expn& e) {
+    Ltrl_ptr l { new Ltrl {v, e.where()} };
+    l->type = e.type;
+    return l;
+}
+
+//
+// fold(e,opnds)
+//
+// Gives a literal for the value of `e` when all its operands `opnds` are
+// literals. Otherwise, or if evaluating it raises an error, gives `e`.
+//
+static Expn_ptr fold(Expn_ptr e, std::initializer_list<Expn_ptr> opnds) {
+    for (const Expn_ptr& o : opnds) {
+        if (!as_ltrl(o)) return e;
+    }
+    try {
+        Stck stck {};
+        Ctxt ctxt {stck, 0};
+        return ltrl(e->eval(Defs {}, ctxt), *e);
+    } catch (DwislpyError& err) {
+        return e;
+    }
+}
+
+// * * * * *
+//
+// Inlining, at -O3.
+//
+// A call of a function whose body is just `return e` can be replaced by
+// a copy of `e` with each formal replaced by the argument given for it.
+// This is done when `e` is made of at most INLINE_MAX literals, formals,
+// and operations on them (so, making no calls, the function is not
+// recursive), and when every argument is a variable or a literal, so
+// that no argument is evaluated a different number of times, or in a
+// different order, than the call would have evaluated it.
+//
+// The copies keep the locations of the callee, and so any error that
+// the inlined code raises is reported just where the call would have
+// reported it.
+//
+
+static const int INLINE_MAX = 16;
+
+static Expn_ptr copy_pure(Expn_ptr e) {
+    if (Ltrl_ptr l = as_ltrl(e)) {
+        return ltrl(l->valu, *l);
+    }
+    Lkup* v = dynamic_cast<Lkup*>(e);
+    Lkup* c { new Lkup {v->name, v->where()} };
+    c->slot = v->slot;
+    c->type = v->type;
+    return c;
+}
+
+static Expn_ptr copy_body(Expn_ptr e, const Expn_vec& args, int& budget);
+
+template <typename N>
+static Expn_ptr copy_unary(const N& n, Expn_ptr e, const Expn_vec& args, int& budget) {
+    Expn_ptr ec = copy_body(e, args, budget);
+    if (!ec) return nullptr;
+    N* c { new N {ec, n.where()} };
+    c->type = n.type;
+    return c;
+}
+
+template <typename N>
+static Expn_ptr copy_binary(const N& n, Expn_ptr l, Expn_ptr r, const Expn_vec& args, int& budget) {
+    Expn_ptr lc = copy_body(l, args, budget);
+    Expn_ptr rc = lc ? copy_body(r, args, budget) : nullptr;
+    if (!rc) return nullptr;
+    N* c { new N {lc, rc, n.where()} };
+    c->type = n.type;
+    return c;
+}
+
+//
+// copy_body(e,args,budget)
+//
+// Copies the callee's expression `e`, replacing its formals by `args`,
+// or gives nullptr if `e` is not made only of what can be inlined, or
+// if it has more than `budget` parts.
+//
+static Expn_ptr copy_body(Expn_ptr e, const Expn_vec& args, int& budget) {
+    if (--budget < 0) {
+        return nullptr;
+    }
+    if (Ltrl_ptr l = as_ltrl(e)) {
+        return ltrl(l->valu, *l);
+    }
+    if (Lkup* v = dynamic_cast<Lkup*>(e)) {
+        // The body of a lone return has no locals, only formals.
+        return copy_pure(args[v->slot]);
+    }
+    if (Plus* n = dynamic_cast<Plus*>(e)) return copy_binary(*n, n->left, n->rght, args, budget);
+    if (Mnus* n = dynamic_cast<Mnus*>(e)) return copy_binary(*n, n->left, n->rght, args, budget);
+    if (Tmes* n = dynamic_cast<Tmes*>(e)) return copy_binary(*n, n->left, n->rght, args, budget);
+    if (IDiv* n = dynamic_cast<IDiv*>(e)) return copy_binary(*n, n->left, n->rght, args, budget);
+    if (IMod* n = dynamic_cast<IMod*>(e)) return copy_binary(*n, n->left, n->rght, args, budget);
+    if (Cmlt* n = dynamic_cast<Cmlt*>(e)) return copy_binary(*n, n->lft, n->rht, args, budget);
+    if (Cmgt* n = dynamic_cast<Cmgt*>(e)) return copy_binary(*n, n->lft, n->rht, args, budget);
+    if (Cmeq* n = dynamic_cast<Cmeq*>(e)) return copy_binary(*n, n->lft, n->rht, args, budget);
+    if (Cmle* n = dynamic_cast<Cmle*>(e)) return copy_binary(*n, n->lft, n->rht, args, budget);
+    if (Cmge* n = dynamic_cast<Cmge*>(e)) return copy_binary(*n, n->lft, n->rht, args, budget);
+    if (Conj* n = dynamic_cast<Conj*>(e)) return copy_binary(*n, n->lft, n->rht, args, budget);
+    if (Disj* n = dynamic_cast<Disj*>(e)) return copy_binary(*n, n->lft, n->rht, args, budget);
+    if (Negt* n = dynamic_cast<Negt*>(e)) return copy_unary(*n, n->expn, args, budget);
+    if (Imus* n = dynamic_cast<Imus*>(e)) return copy_unary(*n, n->expn, args, budget);
+    if (Inif* n = dynamic_cast<Inif*>(e)) {
+        Expn_ptr ic = copy_body(n->if_br, args, budget);
+        Expn_ptr cc = ic ? copy_body(n->cond, args, budget) : nullptr;
+        Expn_ptr ec = cc ? copy_body(n->else_br, args, budget) : nullptr;
+        if (!ec) return nullptr;
+        Inif* c { new Inif {ic, cc, ec, n->where()} };
+        c->type = n->type;
+        return c;
+    }
+    return nullptr;
+}
+
+//
+// inline_call(call)
+//
+// Gives the inlined body of `call`, or nullptr if it can't be inlined.
+//
+static Expn_ptr inline_call(const FCll& call) {
+    for (Expn_ptr a : call.args) {
+        if (!is_pure(a)) return nullptr;
+    }
+    const Stmt_vec& stmts = call.defn->body->stmts;
+    FRtn* rtrn = stmts.size() == 1 ? dynamic_cast<FRtn*>(stmts[0]) : nullptr;
+    if (!rtrn) {
+        return nullptr;
+    }
+    int budget = INLINE_MAX;
+    return copy_body(rtrn->expn, call.args, budget);
+}
+
+// * * * * *
+//
+// Loops, at -O3.
+//
+// Once its body has been simplified, a `while` or `repeat` loop is
+// rewritten in three ways, each giving statements that are placed just
+// before the loop:
+//
+//   * strength reduction - where `i * c` is used more than once in a
+//     loop whose body's block bumps the int `i` by a variable or
+//     literal `k` (with `i += k` or `i -= k`, its only assignment in
+//     the loop), and `c` is a literal or a variable the loop leaves
+//     alone, a fresh variable `t` set to `i * c` before the loop stands
+//     for each use, with `t += k * c` added just after the bump.
+//
+//   * hoisting - an expression whose variables the loop never assigns
+//     is computed into a fresh variable before the loop, when it is an
+//     int or bool operation that can't fail (so not a call, an input,
+//     or a `//` or `%` other than by a literal that isn't 0). Such an expression gives the same value at each
+//     iteration, and computing it once more or less can't be seen.
+//
+//   * a `while` whose test compares an int variable with a literal, or
+//     with a variable the loop leaves alone (as it is once a bound has
+//     been hoisted), becomes an `IntWhil` (see dwislpy-ast.hh), which
+//     looks up that bound just once.
+//
+// The fresh variables get slots at the end of the frame being
+// optimized, which is kept in `frame` by Prgm::optm and Defn::optm.
+//
+
+static thread_local SymT* frame = nullptr;
+
+typedef std::unordered_map<int,int> Wrts; // Assignments in a loop, by slot.
+
+static int new_temp(Type type) {
+    int slot = static_cast<int>(frame->get_size());
+    frame->add_temp("_t" + std::to_string(slot), type);
+    return slot;
+}
+
+static Lkup* lkup(int slot) {
+    const SymInfo* info = frame->get_slot(slot);
+    Lkup* v { new Lkup {info->name, Locn {}} };
+    v->slot = slot;
+    v->type = info->type;
+    return v;
+}
+
+//
+// each_child(e,f), each_expn(b,f)
+//
+// Apply `f` to (a reference to) each operand of `e`, and to each
+// expression held by a statement of `b` or of a block within it.
+//
+template <typename F>
+static void each_child(Expn_ptr e, F f) {
+    if (Plus* n = dynamic_cast<Plus*>(e)) { f(n->left); f(n->rght); }
+    else if (Mnus* n = dynamic_cast<Mnus*>(e)) { f(n->left); f(n->rght); }
+    else if (Tmes* n = dynamic_cast<Tmes*>(e)) { f(n->left); f(n->rght); }
+    else if (IDiv* n = dynamic_cast<IDiv*>(e)) { f(n->left); f(n->rght); }
+    else if (IMod* n = dynamic_cast<IMod*>(e)) { f(n->left); f(n->rght); }
+    else if (Cmlt* n = dynamic_cast<Cmlt*>(e)) { f(n->lft); f(n->rht); }
+    else if (Cmgt* n = dynamic_cast<Cmgt*>(e)) { f(n->lft); f(n->rht); }
+    else if (Cmeq* n = dynamic_cast<Cmeq*>(e)) { f(n->lft); f(n->rht); }
+    else if (Cmle* n = dynamic_cast<Cmle*>(e)) { f(n->lft); f(n->rht); }
+    else if (Cmge* n = dynamic_cast<Cmge*>(e)) { f(n->lft); f(n->rht); }
+    else if (Conj* n = dynamic_cast<Conj*>(e)) { f(n->lft); f(n->rht); }
+    else if (Disj* n = dynamic_cast<Disj*>(e)) { f(n->lft); f(n->rht); }
+    else if (Negt* n = dynamic_cast<Negt*>(e)) { f(n->expn); }
+    else if (Imus* n = dynamic_cast<Imus*>(e)) { f(n->expn); }
+    else if (Inpt* n = dynamic_cast<Inpt*>(e)) { f(n->expn); }
+    else if (IntC* n = dynamic_cast<IntC*>(e)) { f(n->expn); }
+    else if (StrC* n = dynamic_cast<StrC*>(e)) { f(n->expn); }
+    else if (Inif* n = dynamic_cast<Inif*>(e)) { f(n->if_br); f(n->cond); f(n->else_br); }
+    else if (FCll* n = dynamic_cast<FCll*>(e)) { for (Expn_ptr& a : n->args) f(a); }
+}
+
+template <typename F>
+static void each_expn(Blck_ptr b, F f) {
+    for (Stmt_ptr s : b->stmts) {
+        if (Asgn* n = dynamic_cast<Asgn*>(s)) f(n->expn);
+        else if (Ntro* n = dynamic_cast<Ntro*>(s)) f(n->expn);
+        else if (Pleq* n = dynamic_cast<Pleq*>(s)) f(n->expn);
+        else if (Mneq* n = dynamic_cast<Mneq*>(s)) f(n->expn);
+        else if (FRtn* n = dynamic_cast<FRtn*>(s)) f(n->expn);
+        else if (Prnt* n = dynamic_cast<Prnt*>(s)) { for (Expn_ptr& e : n->expns) f(e); }
+        else if (PCll* n = dynamic_cast<PCll*>(s)) { for (Expn_ptr& e : n->args) f(e); }
+        else if (Whil* n = dynamic_cast<Whil*>(s)) { f(n->cond); each_expn(n->body, f); }
+        else if (Rept* n = dynamic_cast<Rept*>(s)) { each_expn(n->body, f); f(n->cond); }
+        else if (Cond* n = dynamic_cast<Cond*>(s)) {
+            for (Ifcd_ptr ifcd : n->ifcds) {
+                f(ifcd->cond);
+                each_expn(ifcd->body, f);
+            }
+            if (n->els) each_expn(n->els->body, f);
+        }
+    }
+}
+
+static void count_wrts(Blck_ptr b, Wrts& wrts) {
+    for (Stmt_ptr s : b->stmts) {
+        if (Asgn* n = dynamic_cast<Asgn*>(s)) wrts[n->slot]++;
+        else if (Ntro* n = dynamic_cast<Ntro*>(s)) wrts[n->slot]++;
+        else if (Pleq* n = dynamic_cast<Pleq*>(s)) wrts[n->slot]++;
+        else if (Mneq* n = dynamic_cast<Mneq*>(s)) wrts[n->slot]++;
+        else if (Whil* n = dynamic_cast<Whil*>(s)) count_wrts(n->body, wrts);
+        else if (Rept* n = dynamic_cast<Rept*>(s)) count_wrts(n->body, wrts);
+        else if (Cond* n = dynamic_cast<Cond*>(s)) {
+            for (Ifcd_ptr ifcd : n->ifcds) {
+                count_wrts(ifcd->body, wrts);
+            }
+            if (n->els) count_wrts(n->els->body, wrts);
+        }
+    }
+}
+
+//
+// is_invariant(e,wrts)
+//
+// Whether `e` gives the same value, and does nothing else, each time
+// the loop that makes the assignments `wrts` evaluates it.
+//
+static bool is_invariant(Expn_ptr e, const Wrts& wrts) {
+    if (as_ltrl(e)) {
+        return true;
+    }
+    if (Lkup* v = dynamic_cast<Lkup*>(e)) {
+        return wrts.count(v->slot) == 0;
+    }
+    IDiv* dv = dynamic_cast<IDiv*>(e);
+    IMod* md = dynamic_cast<IMod*>(e);
+    Expn_ptr divisor = dv ? dv->rght : md ? md->rght : nullptr;
+    bool divides = divisor && as_ltrl(divisor) && !is_int_ltrl(divisor, 0);
+    if (!(divides
+          || dynamic_cast<Plus*>(e) || dynamic_cast<Mnus*>(e) || dynamic_cast<Tmes*>(e)
+          || dynamic_cast<Cmlt*>(e) || dynamic_cast<Cmgt*>(e) || dynamic_cast<Cmeq*>(e)
+          || dynamic_cast<Cmle*>(e) || dynamic_cast<Cmge*>(e)
+          || dynamic_cast<Conj*>(e) || dynamic_cast<Disj*>(e)
+          || dynamic_cast<Negt*>(e) || dynamic_cast<Imus*>(e) || dynamic_cast<Inif*>(e))
+        || !(is_int(e->type) || is_bool(e->type))) {
+        return false;
+    }
+    bool invariant = true;
+    each_child(e, [&](Expn_ptr& c) { invariant = invariant && is_invariant(c, wrts); });
+    return invariant;
+}
+
+static void hoist(Expn_ptr& e, const Wrts& wrts, Stmt_vec& before) {
+    if (is_pure(e)) {
+        return;
+    }
+    if (is_invariant(e, wrts)) {
+        int slot = new_temp(e->type);
+        Ntro* nt { new Ntro {frame->get_slot(slot)->name, e->type, e, e->where()} };
+        nt->slot = slot;
+        before.push_back(nt);
+        e = lkup(slot);
+        return;
+    }
+    each_child(e, [&](Expn_ptr& c) { hoist(c, wrts, before); });
+}
+
+//
+// reduce(body,cond,wrts,before)
+//
+// Strength reduction of the products of each bump at the top of `body`.
+//
+static void reduce(Blck_ptr body, Expn_ptr& cond, const Wrts& wrts, Stmt_vec& before) {
+    Stmt_vec stmts {};
+    for (Stmt_ptr s : body->stmts) {
+        stmts.push_back(s);
+        Pleq* pl = dynamic_cast<Pleq*>(s);
+        Mneq* mn = dynamic_cast<Mneq*>(s);
+        int i = pl ? pl->slot : mn ? mn->slot : -1;
+        Expn_ptr k = pl ? pl->expn : mn ? mn->expn : nullptr;
+        if (i < 0 || !is_int(frame->get_slot(i)->type)
+            || wrts.at(i) != 1 || !is_pure(k) || !is_invariant(k, wrts)) {
+            continue;
+        }
+        //
+        // Find the uses of each `i * c`, keyed by the literal value or the
+        // slot of `c`.
+        //
+        std::unordered_map<std::string,std::vector<Expn_ptr*>> uses {};
+        std::vector<std::string> order {};
+        std::function<void(Expn_ptr&)> find = [&](Expn_ptr& e) {
+            Tmes* m = dynamic_cast<Tmes*>(e);
+            if (m && is_int(m->type)) {
+                Lkup* lv = dynamic_cast<Lkup*>(m->left);
+                Lkup* rv = dynamic_cast<Lkup*>(m->rght);
+                Expn_ptr c = lv && lv->slot == i ? m->rght : rv && rv->slot == i ? m->left : nullptr;
+                if (c && is_pure(c) && is_invariant(c, wrts)) {
+                    Ltrl_ptr l = as_ltrl(c);
+                    std::string key = l ? "#" + to_string(l->valu)
+                                        : "@" + std::to_string(dynamic_cast<Lkup*>(c)->slot);
+                    if (uses.find(key) == uses.end()) order.push_back(key);
+                    uses[key].push_back(&e);
+                    return;
+                }
+            }
+            each_child(e, find);
+        };
+        find(cond);
+        each_expn(body, find);
+        for (const std::string& key : order) {
+            const std::vector<Expn_ptr*>& at = uses[key];
+            if (at.size() < 2) {
+                continue;
+            }
+            Tmes* m = dynamic_cast<Tmes*>(*at[0]);
+            Lkup* lv = dynamic_cast<Lkup*>(m->left);
+            Expn_ptr c = lv && lv->slot == i ? m->rght : m->left;
+            int t = new_temp(INT_T);
+            Ntro* nt { new Ntro {frame->get_slot(t)->name, INT_T, m, m->where()} };
+            nt->slot = t;
+            before.push_back(nt);
+            for (Expn_ptr* e : at) {
+                *e = lkup(t);
+            }
+            Tmes* kc { new Tmes {copy_pure(k), copy_pure(c), s->where()} };
+            kc->type = INT_T;
+            Expn_ptr step = is_int_ltrl(k, 1) ? copy_pure(c) : fold(kc, {kc->left, kc->rght});
+            Stmt_ptr bump;
+            if (pl) {
+                Pleq* b { new Pleq {frame->get_slot(t)->name, step, s->where()} };
+                b->slot = t;
+                bump = b;
+            } else {
+                Mneq* b { new Mneq {frame->get_slot(t)->name, step, s->where()} };
+                b->slot = t;
+                bump = b;
+            }
+            stmts.push_back(bump);
+        }
+    }
+    body->stmts = stmts;
+}
+
+//
+// optm_loop(cond,body,before)
+//
+// Reduces and hoists what it can from a loop, giving the statements to
+// run before it in `before`.
+//
+static void optm_loop(Expn_ptr& cond, Blck_ptr body, Stmt_vec& before) {
+    Wrts wrts {};
+    count_wrts(body, wrts);
+    reduce(body, cond, wrts, before);
+    wrts.clear();
+    count_wrts(body, wrts);
+    auto hoister = [&](Expn_ptr& e) { hoist(e, wrts, before); };
+    hoister(cond);
+    each_expn(body, hoister);
+}
+
+//
+// counted(loop)
+//
+// Gives an `IntWhil` for `loop`, or nullptr if its test isn't suitable.
+//
+static Stmt_ptr counted(const Whil& loop) {
+    Expn_ptr lft = nullptr;
+    Expn_ptr rht = nullptr;
+    IntWhil::Test test = IntWhil::LT;
+    if (Cmlt* c = dynamic_cast<Cmlt*>(loop.cond)) { lft = c->lft; rht = c->rht; test = IntWhil::LT; }
+    else if (Cmle* c = dynamic_cast<Cmle*>(loop.cond)) { lft = c->lft; rht = c->rht; test = IntWhil::LE; }
+    else if (Cmgt* c = dynamic_cast<Cmgt*>(loop.cond)) { lft = c->lft; rht = c->rht; test = IntWhil::GT; }
+    else if (Cmge* c = dynamic_cast<Cmge*>(loop.cond)) { lft = c->lft; rht = c->rht; test = IntWhil::GE; }
+    Lkup* v = dynamic_cast<Lkup*>(lft);
+    if (!v || !is_int(v->type) || !is_int(rht->type) || !is_pure(rht)) {
+        return nullptr;
+    }
+    Wrts wrts {};
+    count_wrts(loop.body, wrts);
+    if (!is_invariant(rht, wrts)) {
+        return nullptr;
+    }
+    return Stmt_ptr { new IntWhil {loop.cond, loop.body, v->slot, test, rht, loop.where()} };
+}
+
+// * * * * *
+//
+// Prgm::optm, Defn::optm, Blck::optm
+//
+
+void Prgm::optm(int level) {
+    if (level <= 0) return;
+    for (auto [name, defn] : defs) {
+        if (!defn->ready) defn->optm(level);
+    }
+    if (main) {
+        frame = &main_symt;
+        main->optm(level);
+        frame = nullptr;
+    }
+}
+
+Stmt_vec Prgm::optm(Stmt_ptr s, int level) {
+    if (level <= 0) return Stmt_vec {s};
+    frame = &main_symt;
+    Stmt_vec ss = s->optm(s, level);
+    frame = nullptr;
+    return ss;
+}
+
+void Defn::optm(int level) {
+    frame = &args;
+    body->optm(level);
+    frame = nullptr;
+}
+
+void Blck::optm(int level) {
+    Stmt_vec live {};
+    bool returned = false;
+    for (Stmt_ptr s : stmts) {
+        for (Stmt_ptr t : s->optm(s, level)) {
+            if (dynamic_cast<Pass*>(t)) {
+                continue;
+            }
+            live.push_back(t);
+            if (dynamic_cast<FRtn*>(t) || dynamic_cast<PRtn*>(t)) {
+                returned = true;
+                break;
+            }
+        }
+        if (returned) break;
+    }
+    if (live.empty()) {
+        live.push_back(Pass_ptr { new Pass {where()} });
+    }
+    stmts = live;
+}
+
+// * * * * *
+//
+// Stmt::optm
+//
+
+Stmt_vec Stmt::optm(Stmt_ptr self, [[maybe_unused]] int level) {
+    return Stmt_vec {self};
+}
+
+Stmt_vec Asgn::optm(Stmt_ptr self, int level) {
+    expn = expn->optm(expn, level);
+    return Stmt_vec {self};
+}
+
+Stmt_vec Ntro::optm(Stmt_ptr self, int level) {
+    expn = expn->optm(expn, level);
+    return Stmt_vec {self};
+}
+
+Stmt_vec Pleq::optm(Stmt_ptr self, int level) {
+    expn = expn->optm(expn, level);
+    return Stmt_vec {self};
+}
+
+Stmt_vec Mneq::optm(Stmt_ptr self, int level) {
+    expn = expn->optm(expn, level);
+    return Stmt_vec {self};
+}
+
+Stmt_vec FRtn::optm(Stmt_ptr self, int level) {
+    expn = expn->optm(expn, level);
+    return Stmt_vec {self};
+}
+
+Stmt_vec Prnt::optm(Stmt_ptr self, int level) {
+    for (Expn_ptr& e : expns) {
+        e = e->optm(e, level);
+    }
+    return Stmt_vec {self};
+}
+
+Stmt_vec PCll::optm(Stmt_ptr self, int level) {
+    for (Expn_ptr& e : args) {
+        e = e->optm(e, level);
+    }
+    return Stmt_vec {self};
+}
+
+Stmt_vec Cond::optm(Stmt_ptr self, int level) {
+    //
+    // The conditions are tested in the order of `ifcds`. Those that are
+    // False can never be taken. The first that is True is always taken
+    // if reached, so it becomes the `else`, and those after it are dead.
+    //
+    Ifcd_vec live {};
+    Else_ptr dflt = els;
+    for (Ifcd_ptr ifcd : ifcds) {
+        ifcd->cond = ifcd->cond->optm(ifcd->cond, level);
+        if (is_bool_ltrl(ifcd->cond, false)) {
+            continue;
+        }
+        if (is_bool_ltrl(ifcd->cond, true)) {
+            dflt = Else_ptr { new Else {ifcd->body, ifcd->where()} };
+            break;
+        }
+        live.push_back(ifcd);
+    }
+    for (Ifcd_ptr ifcd : live) {
+        ifcd->body->optm(level);
+    }
+    if (dflt) {
+        dflt->body->optm(level);
+    }
+    if (live.empty()) {
+        return dflt ? dflt->body->stmts : Stmt_vec {};
+    }
+    ifcds = live;
+    els = dflt;
+    return Stmt_vec {self};
+}
+
+Stmt_vec Whil::optm(Stmt_ptr self, int level) {
+    cond = cond->optm(cond, level);
+    if (is_bool_ltrl(cond, false)) {
+        return Stmt_vec {};
+    }
+    body->optm(level);
+    if (level < 3) {
+        return Stmt_vec {self};
+    }
+    Stmt_vec stmts {};
+    optm_loop(cond, body, stmts);
+    Stmt_ptr cntd = counted(*this);
+    stmts.push_back(cntd ? cntd : self);
+    return stmts;
+}
+
+Stmt_vec Rept::optm(Stmt_ptr self, int level) {
+    cond = cond->optm(cond, level);
+    body->optm(level);
+    if (is_bool_ltrl(cond, true)) {
+        // The body runs just the once.
+        return body->stmts;
+    }
+    if (level < 3) {
+        return Stmt_vec {self};
+    }
+    Stmt_vec stmts {};
+    optm_loop(cond, body, stmts);
+    stmts.push_back(self);
+    return stmts;
+}
+
+// * * * * *
+//
+// Expn::optm
+//
+
+Expn_ptr Expn::optm(Expn_ptr self, [[maybe_unused]] int level) {
+    return self;
+}
+
+Expn_ptr Inif::optm(Expn_ptr self, int level) {
+    if_br = if_br->optm(if_br, level);
+    cond = cond->optm(cond, level);
+    else_br = else_br->optm(else_br, level);
+    if (is_bool_ltrl(cond, true)) {
+        return if_br;
+    } else if (is_bool_ltrl(cond, false)) {
+        return else_br;
+    }
+    return self;
+}
+
+Expn_ptr Negt::optm(Expn_ptr self, int level) {
+    expn = expn->optm(expn, level);
+    if (level >= 2) {
+        Expn_ptr e = nullptr;
+        if (auto n = dynamic_cast<Negt*>(expn)) {
+            return n->expn;
+        } else if (auto c = dynamic_cast<Cmlt*>(expn)) {
+            e = Cmge_ptr { new Cmge {c->lft, c->rht, where()} };
+        } else if (auto c = dynamic_cast<Cmge*>(expn)) {
+            e = Cmlt_ptr { new Cmlt {c->lft, c->rht, where()} };
+        } else if (auto c = dynamic_cast<Cmgt*>(expn)) {
+            e = Cmle_ptr { new Cmle {c->lft, c->rht, where()} };
+        } else if (auto c = dynamic_cast<Cmle*>(expn)) {
+            e = Cmgt_ptr { new Cmgt {c->lft, c->rht, where()} };
+        }
+        if (e) {
+            e->type = type;
+            return e;
+        }
+    }
+    return fold(self, {expn});
+}
+
+Expn_ptr Imus::optm(Expn_ptr self, int level) {
+    expn = expn->optm(expn, level);
+    if (level >= 2) {
+        if (auto m = dynamic_cast<Imus*>(expn)) {
+            return m->expn;
+        }
+    }
+    return fold(self, {expn});
+}
+
+Expn_ptr Conj::optm(Expn_ptr self, int level) {
+    lft = lft->optm(lft, level);
+    rht = rht->optm(rht, level);
+    if (is_bool_ltrl(lft, true)) {
+        return rht;
+    } else if (is_bool_ltrl(lft, false)) {
+        return lft;
+    }
+    if (level >= 2) {
+        if (is_bool_ltrl(rht, true)) {
+            return lft;
+        } else if (is_bool_ltrl(rht, false) && is_pure(lft)) {
+            return rht;
+        }
+    }
+    return self;
+}
+
+Expn_ptr Disj::optm(Expn_ptr self, int level) {
+    lft = lft->optm(lft, level);
+    rht = rht->optm(rht, level);
+    if (is_bool_ltrl(lft, false)) {
+        return rht;
+    } else if (is_bool_ltrl(lft, true)) {
+        return lft;
+    }
+    if (level >= 2) {
+        if (is_bool_ltrl(rht, false)) {
+            return lft;
+        } else if (is_bool_ltrl(rht, true) && is_pure(lft)) {
+            return rht;
+        }
+    }
+    return self;
+}
+
+Expn_ptr Cmlt::optm(Expn_ptr self, int level) {
+    lft = lft->optm(lft, level);
+    rht = rht->optm(rht, level);
+    return fold(self, {lft, rht});
+}
+
+Expn_ptr Cmgt::optm(Expn_ptr self, int level) {
+    lft = lft->optm(lft, level);
+    rht = rht->optm(rht, level);
+    return fold(self, {lft, rht});
+}
+
+Expn_ptr Cmeq::optm(Expn_ptr self, int level) {
+    lft = lft->optm(lft, level);
+    rht = rht->optm(rht, level);
+    return fold(self, {lft, rht});
+}
+
+Expn_ptr Cmle::optm(Expn_ptr self, int level) {
+    lft = lft->optm(lft, level);
+    rht = rht->optm(rht, level);
+    return fold(self, {lft, rht});
+}
+
+Expn_ptr Cmge::optm(Expn_ptr self, int level) {
+    lft = lft->optm(lft, level);
+    rht = rht->optm(rht, level);
+    return fold(self, {lft, rht});
+}
+
+Expn_ptr FCll::optm(Expn_ptr self, int level) {
+    for (Expn_ptr& e : args) {
+        e = e->optm(e, level);
+    }
+    if (level >= 3) {
+        if (Expn_ptr e = inline_call(*this)) {
+            return e->optm(e, level);
+        }
+    }
+    return self;
+}
+
+Expn_ptr Plus::optm(Expn_ptr self, int level) {
+    left = left->optm(left, level);
+    rght = rght->optm(rght, level);
+    if (level >= 2) {
+        if (is_int_ltrl(rght, 0) || is_empty_str_ltrl(rght)) {
+            return left;
+        } else if (is_int_ltrl(left, 0) || is_empty_str_ltrl(left)) {
+            return rght;
+        }
+    }
+    return fold(self, {left, rght});
+}
+
+Expn_ptr Mnus::optm(Expn_ptr self, int level) {
+    left = left->optm(left, level);
+    rght = rght->optm(rght, level);
+    if (level >= 2 && is_int_ltrl(rght, 0)) {
+        return left;
+    }
+    return fold(self, {left, rght});
+}
+
+Expn_ptr Tmes::optm(Expn_ptr self, int level) {
+    left = left->optm(left, level);
+    rght = rght->optm(rght, level);
+    if (level >= 2) {
+        if (is_int_ltrl(rght, 1)) {
+            return left;
+        } else if (is_int(type) && is_int_ltrl(left, 1)) {
+            return rght;
+        } else if (is_int(type) && is_int_ltrl(rght, 0) && is_pure(left)) {
+            return rght;
+        } else if (is_int(type) && is_int_ltrl(left, 0) && is_pure(rght)) {
+            return left;
+        }
+    }
+    Ltrl_ptr ls = as_ltrl(left);
+    Ltrl_ptr rn = as_ltrl(rght);
+    if (ls && rn && std::holds_alternative<Strg>(ls->valu)) {
+        if (!std::holds_alternative<Word>(rn->valu)) {
+            return self;
+        }
+        Word n = std::get<Word>(rn->valu);
+        if (n > 0 && (n > static_cast<Word>(FOLD_STR_MAX)
+                      || n * std::get<Strg>(ls->valu).size() > FOLD_STR_MAX)) {
+            return self;
+        }
+    }
+    return fold(self, {left, rght});
+}
+
+Expn_ptr IDiv::optm(Expn_ptr self, int level) {
+    left = left->optm(left, level);
+    rght = rght->optm(rght, level);
+    if (level >= 2 && is_int_ltrl(rght, 1)) {
+        return left;
+    }
+    return fold(self, {left, rght});
+}
+
+Expn_ptr IMod::optm(Expn_ptr self, int level) {
+    left = left->optm(left, level);
+    rght = rght->optm(rght, level);
+    if (level >= 2 && is_int_ltrl(rght, 1) && is_pure(left)) {
+        return ltrl(Valu {0}, *this);
+    }
+    return fold(self, {left, rght});
+}
+
+Expn_ptr Inpt::optm(Expn_ptr self, int level) {
+    expn = expn->optm(expn, level);
+    return self;
+}
+
+Expn_ptr IntC::optm(Expn_ptr self, int level) {
+    expn = expn->optm(expn, level);
+    return fold(self, {expn});
+}
+
+Expn_ptr StrC::optm(Expn_ptr self, int level) {
+    expn = expn->optm(expn, level);
+    return fold(self, {expn});
+}
@@ -0,0 +1,149 @@
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <iterator>
+#include <chrono>
+#include <atomic>
+#include <thread>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+
+#include "dwislpy-prof.hh"
+#include "dwislpy-ast.hh"
+
+//
+// dwislpy-prof.cc
+//
+// The profiler. See the header (.hh) file for details.
+//
+
+Prof::Prof(void) : frames {Frame {nullptr, nullptr}}, last {Clock::now()} {
+    defns[nullptr].calls = 1;
+    ticker = std::thread {[this](void) {
+        while (!stopping.load()) {
+            std::this_thread::sleep_for(PERIOD);
+            due.store(true, std::memory_order_relaxed);
+        }
+    }};
+}
+
+Prof::~Prof(void) {
+    if (!stopping.exchange(true)) {
+        ticker.join();
+    }
+}
+
+void Prof::sample(void) {
+    due.store(false, std::memory_order_relaxed);
+    Clock::time_point now = Clock::now();
+    std::uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count();
+    last = now;
+    samples++;
+    //
+    // A frame that has yet to run a statement is still being called, so
+    // the time goes to the statement making the call.
+    //
+    auto f = frames.rbegin();
+    while (!f->stmt && std::next(f) != frames.rend()) f++;
+    stmts[f->stmt].ns += ns;
+    defns[frames.back().defn].excl += ns;
+    std::vector<const Defn*> stack {};
+    stack.reserve(frames.size());
+    for (const Frame& f : frames) {
+        Cost& c = defns[f.defn];
+        if (c.mark != samples) {
+            c.mark = samples;
+            c.incl += ns;
+        }
+        stack.push_back(f.defn);
+    }
+    stacks_ns[stack] += ns;
+}
+
+void Prof::finish(void) {
+    if (!stopping.exchange(true)) {
+        ticker.join();
+        sample();
+    }
+}
+
+static std::string name_of(const Defn* d) {
+    return d ? d->name : "<main>";
+}
+
+static double ms(std::uint64_t ns) {
+    return ns / 1e6;
+}
+
+void Prof::report(std::ostream& os, const std::string& name, std::string_view text) const {
+    //
+    // Sum up the statements that start on each line.
+    //
+    std::vector<std::string_view> lines {};
+    for (std::size_t at = 0; at < text.size(); ) {
+        std::size_t end = text.find('\n', at);
+        if (end == std::string_view::npos) end = text.size();
+        lines.push_back(text.substr(at, end - at));
+        at = end + 1;
+    }
+    std::vector<Line> per_line(lines.size() + 1);
+    std::uint64_t count = 0;
+    std::uint64_t total = 0;
+    for (const auto& [stmt, line] : stmts) {
+        count += line.count;
+        total += line.ns;
+        int n = stmt ? stmt->where().line() : 0;
+        if (n > 0 && static_cast<std::size_t>(n) <= lines.size()) {
+            per_line[n].count += line.count;
+            per_line[n].ns += line.ns;
+        }
+    }
+    os << "Profile of " << name << ": " << count << " statements run in "
+       << std::fixed << std::setprecision(3) << ms(total) << " ms." << std::endl
+       << std::endl;
+    os << "       count         ms | source" << std::endl;
+    for (std::size_t n = 1; n <= lines.size(); n++) {
+        const Line& line = per_line[n];
+        if (line.count > 0) {
+            os << std::setw(12) << line.count << " "
+               << std::setw(10) << std::setprecision(2) << ms(line.ns);
+        } else {
+            os << std::string(23, ' ');
+        }
+        os << " | " << lines[n - 1] << std::endl;
+    }
+    //
+    // Then the definitions, those taking the most time first.
+    //
+    std::vector<std::pair<const Defn*,Cost>> costs {defns.begin(), defns.end()};
+    std::sort(costs.begin(), costs.end(), [](const auto& c1, const auto& c2) {
+        return c1.second.incl > c2.second.incl
+            || (c1.second.incl == c2.second.incl && name_of(c1.first) < name_of(c2.first));
+    });
+    os << std::endl
+       << "       calls    incl ms    excl ms  definition" << std::endl;
+    for (const auto& [defn, cost] : costs) {
+        os << std::setw(12) << cost.calls << " "
+           << std::setw(10) << std::setprecision(2) << ms(cost.incl) << " "
+           << std::setw(10) << std::setprecision(2) << ms(cost.excl) << "  "
+           << name_of(defn);
+        if (defn) {
+            os << " (line " << defn->where().line() << ")";
+        }
+        os << std::endl;
+    }
+}
+
+void Prof::stacks(std::ostream& os) const {
+    for (const auto& [stack, ns] : stacks_ns) {
+        if (ns < 1000) continue;
+        for (std::size_t i = 0; i < stack.size(); i++) {
+            os << (i > 0 ? ";" : "") << name_of(stack[i]);
+        }
+        os << " " << ns / 1000 << std::endl;
+    }
+}
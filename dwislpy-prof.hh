@@ -0,0 +1,94 @@
+#ifndef _DWISLPY_PROF_H
+#define _DWISLPY_PROF_H
+
+//
+// dwislpy-prof.hh
+//
+// Defines `Prof`, the profiler of the tree-walking interpreter, which
+// is selected with `--profile`. While a program runs, the interpreter
+// tells it of each statement it is about to execute (`step`), and of
+// each call of a definition it starts and finishes (`enter`, `leave`).
+//
+// Statements and calls are counted exactly. Time is sampled instead,
+// since reading the clock costs more than running most statements. A
+// thread of the profiler's own marks a sample as `due` every PERIOD,
+// and the next `step` then charges the time since the last sample to
+// the statement that was running, to the definition it is in (its
+// exclusive time), to each of the definitions in progress (inclusive
+// time, once each however deeply they recurse), and to the whole stack
+// of calls.
+//
+// Afterwards it writes
+//
+//   report - the source, each line annotated with how many times its
+//            statements ran and the time spent there, followed by the
+//            calls to, and time in, each definition
+//
+//   stacks - the time spent in each stack of calls, as "collapsed"
+//            stacks (e.g. `<main>;fib;fib 1234`, in microseconds), the
+//            form read by flame graph tools
+//
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <chrono>
+#include <atomic>
+#include <thread>
+#include <cstdint>
+#include <ostream>
+#include "dwislpy-ast.hh"
+
+class Prof {
+public:
+    static constexpr std::chrono::microseconds PERIOD {1000};
+    Prof(void);
+    Prof(const Prof&) = delete;
+    Prof& operator=(const Prof&) = delete;
+    ~Prof(void);
+    void step(const Stmt* s) {
+        stmts[s].count++;
+        if (due.load(std::memory_order_relaxed)) sample();
+        frames.back().stmt = s;
+    }
+    void enter(const Defn& d) {
+        defns[&d].calls++;
+        frames.push_back(Frame {&d, nullptr});
+    }
+    void leave(void) {
+        frames.pop_back();
+    }
+    void finish(void); // Stop sampling, charging the time since the last sample.
+    void report(std::ostream& os, const std::string& name, std::string_view text) const;
+    void stacks(std::ostream& os) const;
+private:
+    typedef std::chrono::steady_clock Clock;
+    struct Frame {
+        const Defn* defn; // nullptr for the main script
+        const Stmt* stmt; // The statement being run.
+    };
+    struct Line {
+        std::uint64_t count = 0;
+        std::uint64_t ns = 0;
+    };
+    struct Cost {
+        std::uint64_t calls = 0;
+        std::uint64_t incl = 0;
+        std::uint64_t excl = 0;
+        std::uint64_t mark = 0; // The last sample charged to `incl`.
+    };
+    void sample(void);
+    std::unordered_map<const Stmt*,Line> stmts;
+    std::unordered_map<const Defn*,Cost> defns;
+    std::map<std::vector<const Defn*>,std::uint64_t> stacks_ns;
+    std::vector<Frame> frames;
+    std::uint64_t samples = 0;
+    Clock::time_point last;
+    std::atomic<bool> due {false};
+    std::atomic<bool> stopping {false};
+    std::thread ticker;
+};
+
+#endif
@@ -0,0 +1,60 @@
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <ostream>
+#include <cxxabi.h>
+
+#include "dwislpy-stats.hh"
+
+//
+// dwislpy-stats.cc
+//
+// The counters of `--stats`. See the header (.hh) file for details.
+//
+
+thread_local Stats* Stats::current = nullptr;
+
+#ifdef DWISLPY_STATS
+
+// The name of a class, as in the source rather than as mangled.
+static std::string class_name(const std::type_index& type) {
+    int status = 0;
+    char* name = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+    std::string result = status == 0 ? name : type.name();
+    std::free(name);
+    return result;
+}
+
+#endif
+
+//
+// report(os)
+//
+// Writes each counter as a line "stats <name> <count>", with the count
+// of each kind of statement executed, most first, on lines of their own.
+//
+void Stats::report(std::ostream& os) const {
+#ifndef DWISLPY_STATS
+    os << "stats not counted (build with `make STATS=1`)" << std::endl;
+#else
+    os << "stats reads " << reads << std::endl
+       << "stats writes " << writes << std::endl
+       << "stats strings " << strings << std::endl
+       << "stats bytes " << bytes << std::endl
+       << "stats copies " << copies << std::endl
+       << "stats calls " << calls << std::endl
+       << "stats depth " << depth << std::endl
+       << "stats output " << output << std::endl;
+    std::vector<std::pair<std::string,unsigned long long>> kinds {};
+    for (const auto& [type, count] : stmts) {
+        kinds.emplace_back(class_name(type), count);
+    }
+    std::sort(kinds.begin(), kinds.end(), [](const auto& k1, const auto& k2) {
+        return k1.second > k2.second || (k1.second == k2.second && k1.first < k2.first);
+    });
+    for (const auto& [name, count] : kinds) {
+        os << "stats stmt " << name << " " << count << std::endl;
+    }
+#endif
+}
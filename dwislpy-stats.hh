@@ -0,0 +1,70 @@
+#ifndef _DWISLPY_STATS_H
+#define _DWISLPY_STATS_H
+
+//
+// dwislpy-stats.hh
+//
+// Defines `Stats`, the counters reported by `--stats` once a program has
+// run, to tell whether a slow program is bound by its variables, its
+// strings, its calls, or its output:
+//
+//   reads, writes  - of the variables of frames
+//   strings, bytes - the string texts made, and the characters put in them
+//   copies         - the copies made of a string (each shares the text)
+//   calls, depth   - the definitions called, and the deepest calls went
+//   output         - the characters sent to the output (by `print` and
+//                    by the prompts of `input`)
+//   stmts          - the statements executed, by kind
+//
+// These count what the tree-walking interpreter does: code run on the
+// bytecode machine (with --vm, or once hot under --tiered) only shows
+// in the strings and the output.
+//
+// The counting is compiled in only when DWISLPY_STATS is defined (see
+// STATS in the Makefile), as the DWISLPY_STAT... macros below, so that
+// it costs nothing otherwise. Each counts into the `Stats` in use for
+// the running thread, if any, which is the one set by the innermost
+// `Stats::Use` object.
+//
+
+#include <typeindex>
+#include <unordered_map>
+#include <ostream>
+
+class Stats {
+public:
+    unsigned long long reads = 0;
+    unsigned long long writes = 0;
+    unsigned long long strings = 0;
+    unsigned long long bytes = 0;
+    unsigned long long copies = 0;
+    unsigned long long calls = 0;
+    unsigned int depth = 0;
+    unsigned long long output = 0;
+    std::unordered_map<std::type_index,unsigned long long> stmts;
+    void report(std::ostream& os) const;
+    //
+    class Use {
+    public:
+        Use(Stats& stats) : prev {current} { current = &stats; }
+        ~Use(void) { current = prev; }
+    private:
+        Stats* prev;
+    };
+    static thread_local Stats* current;
+};
+
+#ifdef DWISLPY_STATS
+#define DWISLPY_STAT(counter, n) \
+    do { if (Stats::current) Stats::current->counter += (n); } while (0)
+#define DWISLPY_STAT_MAX(counter, n) \
+    do { if (Stats::current && Stats::current->counter < (n)) Stats::current->counter = (n); } while (0)
+#define DWISLPY_STAT_STMT(s) \
+    do { if (Stats::current) Stats::current->stmts[typeid(*(s))]++; } while (0)
+#else
+#define DWISLPY_STAT(counter, n) ((void)0)
+#define DWISLPY_STAT_MAX(counter, n) ((void)0)
+#define DWISLPY_STAT_STMT(s) ((void)0)
+#endif
+
+#endif
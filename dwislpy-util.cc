@@ -1,4 +1,12 @@
 #include <sstream>
+#include <cstring>
+#include <charconv>
+#include <cerrno>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include "dwislpy-util.hh"
 
 //
@@ -9,6 +17,104 @@
 // See the header (.hh) file for details.
 //
 
+//
+// stack_limit()
+//
+// Asks the threads library where the running thread's stack is. For the
+// main thread, that is as far as the stack's rlimit lets it grow.
+//
+std::uintptr_t stack_limit(void) {
+    std::uintptr_t low = 0;
+    std::size_t size = 0;
+#if defined(__APPLE__)
+    pthread_t self = pthread_self();
+    size = pthread_get_stacksize_np(self);
+    low = reinterpret_cast<std::uintptr_t>(pthread_get_stackaddr_np(self)) - size;
+#elif defined(__linux__)
+    pthread_attr_t attr;
+    if (pthread_getattr_np(pthread_self(), &attr) != 0) {
+        return 0;
+    }
+    void* addr = nullptr;
+    if (pthread_attr_getstack(&attr, &addr, &size) == 0) {
+        low = reinterpret_cast<std::uintptr_t>(addr);
+    }
+    pthread_attr_destroy(&attr);
+#endif
+    if (low == 0 || size <= STACK_MARGIN) {
+        return 0;
+    }
+    return low + STACK_MARGIN;
+}
+
+//
+// class Locs, class Locn
+//
+// - the table of source locations, and the indices into it
+//
+
+thread_local Locs* Locs::current = nullptr;
+
+Locs& Locs::in_use(void) {
+    static thread_local Locs fallback {};
+    return current ? *current : fallback;
+}
+
+Locs::Locs(void) : files {""}, entries {Entry {0, 0, 0}}, file_ids {{"", 0}} { }
+
+void Locs::clear(void) {
+    files.resize(1);
+    entries.resize(1);
+    file_ids = {{"", 0}};
+}
+
+void Locs::truncate(std::size_t n) {
+    if (n >= 1 && n < entries.size()) {
+        entries.resize(n);
+    }
+}
+
+std::uint32_t Locs::add(const std::string& fn, int li, int co) {
+    //
+    // The parser asks for the location of each node as it makes it, so
+    // consecutive requests are often for the same place, in the same file.
+    //
+    const Entry& last = entries.back();
+    std::uint32_t file = last.file;
+    if (files[file] != fn) {
+        auto found = file_ids.find(fn);
+        if (found == file_ids.end()) {
+            file = static_cast<std::uint32_t>(files.size());
+            files.push_back(fn);
+            file_ids[fn] = file;
+        } else {
+            file = found->second;
+        }
+    }
+    if (last.file == file && last.line == li && last.column == co) {
+        return static_cast<std::uint32_t>(entries.size() - 1);
+    }
+    entries.push_back(Entry {file, li, co});
+    return static_cast<std::uint32_t>(entries.size() - 1);
+}
+
+Locn::Locn(const std::string& fn, int li, int co) :
+    id {Locs::in_use().add(fn, li, co)}
+{ }
+
+const std::string& Locn::source_name(void) const {
+    const Locs& locs = Locs::in_use();
+    return locs.files[locs.entries[id].file];
+}
+
+int Locn::line(void) const {
+    return Locs::in_use().entries[id].line;
+}
+
+int Locn::column(void) const {
+    return Locs::in_use().entries[id].column;
+}
+
 //
 // s = dwislpy_message(lo,ms);
 //
@@ -18,9 +124,9 @@
 //
 const std::string dwislpy_message(Locn lo, std::string ms) {
     std::stringstream ss { };
-    ss << lo.source_name << ":";
-    if (lo.column > 0 && lo.line > 0) {
-        ss << lo.line << ":" << lo.column << ":";
+    ss << lo.source_name() << ":";
+    if (lo.column() > 0 && lo.line() > 0) {
+        ss << lo.line() << ":" << lo.column() << ":";
     }
     ss << " " << ms;
     return ss.str();
@@ -40,6 +146,10 @@ const char* DwislpyError::what() const noexcept {
     return message.c_str();
 }
 
+DwislpyError failure(const std::exception& e, const std::string& fn) {
+    return DwislpyError {Locn {fn}, std::string {"Error: "} + e.what() + "."};
+}
+
 //
 // de_escape(s)
 //
@@ -101,6 +211,282 @@ std::string re_escape(std::string s) {
 
 none None;
 
+//
+// class Strg
+//
+//  - the strings held by DWISLPY values
+//
+Strg::Strg(std::string s) : text {nullptr} {
+    if (!s.empty()) {
+        DWISLPY_STAT(strings, 1);
+        DWISLPY_STAT(bytes, s.size());
+        text = new Text {{1}, false, std::move(s)};
+    }
+}
+
+const std::string& Strg::str(void) const {
+    static const std::string empty {};
+    return text ? text->chars : empty;
+}
+
+Strg operator+(const Strg& s1, const Strg& s2) {
+    if (s2.size() == 0) return s1;
+    if (s1.size() == 0) return s2;
+    std::string s;
+    s.reserve(s1.size() + s2.size());
+    s += s1.str();
+    s += s2.str();
+    return Strg {std::move(s)};
+}
+
+void Strg::append(const Strg& s) {
+    if (s.size() == 0) {
+        return;
+    } else if (text && !text->shared && text->refs.load(std::memory_order_relaxed) == 1) {
+        // Only we have this text (and so `s` doesn't), so extend it.
+        text->chars += s.str();
+        DWISLPY_STAT(bytes, s.size());
+    } else {
+        *this = *this + s;
+    }
+}
+
+Strg repeat(const Strg& s, long long n) {
+    if (n <= 0 || s.size() == 0) return Strg {};
+    if (n == 1) return s;
+    std::string r;
+    r.reserve(s.size() * n);
+    for (long long i = 0; i < n; i++) {
+        r += s.str();
+    }
+    return Strg {std::move(r)};
+}
+
+std::ostream& operator<<(std::ostream& os, const Strg& s) {
+    return os << s.str();
+}
+
+//
+// class Sink
+//
+// - buffered output
+//
+
+Sink Sink::out {stdout};
+thread_local Sink* Sink::current = nullptr;
 
+void Sink::put(const char* cs, std::size_t n) {
+    DWISLPY_STAT(output, n);
+    if (n > SIZE - used) {
+        flush();
+        if (n > SIZE) {
+            if (into) {
+                into->append(cs, n);
+            } else {
+                std::fwrite(cs, 1, n, file);
+            }
+            return;
+        }
+    }
+    std::memcpy(buffer + used, cs, n);
+    used += n;
+}
+
+void Sink::put(long long n) {
+    // Room for the digits of any long long, and its sign.
+    if (SIZE - used < 21) flush();
+    char* last = std::to_chars(buffer + used, buffer + SIZE, n).ptr;
+    DWISLPY_STAT(output, last - (buffer + used));
+    used = last - buffer;
+}
+
+void Sink::flush(void) {
+    if (into) {
+        into->append(buffer, used);
+        used = 0;
+        return;
+    }
+    if (used > 0) {
+        std::fwrite(buffer, 1, used, file);
+        used = 0;
+    }
+    std::fflush(file);
+}
+
+//
+// class Feed
+//
+// - buffered input
+//
+
+Feed Feed::in {0};
+thread_local Feed* Feed::current = nullptr;
 
+Feed::~Feed(void) {
+    if (mapped) {
+        munmap(mapped, mapped_size);
+    }
+}
+
+// Whether `c` separates words, just as `std::isspace` in the "C" locale.
+static inline bool is_blank(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
 
+//
+// fill()
+//
+// Reads another chunk of input, keeping whatever of the last one hasn't
+// been scanned yet at the front. Gives whether any more was read.
+//
+bool Feed::fill(void) {
+    if (at_eof) {
+        return false;
+    }
+    std::size_t kept = end - next;
+    if (chunk.size() < kept + CHUNK) {
+        // A word as long as the chunk needs more room.
+        std::vector<char> bigger(kept + CHUNK);
+        std::copy(next, end, bigger.begin());
+        chunk.swap(bigger);
+    } else {
+        std::copy(next, end, chunk.begin());
+    }
+    ssize_t n;
+    do {
+        n = read(fd, chunk.data() + kept, chunk.size() - kept);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) {
+        at_eof = true;
+        n = 0;
+    }
+    next = chunk.data();
+    end = next + kept + n;
+    return n > 0;
+}
+
+std::string_view Feed::word(void) {
+    // Skip to the start of the word.
+    for (;;) {
+        while (next < end && is_blank(*next)) {
+            next++;
+        }
+        if (next < end || !fill()) {
+            break;
+        }
+    }
+    // Scan to its end, reading more if it runs past the chunk.
+    std::size_t length = 0;
+    for (;;) {
+        while (next + length < end && !is_blank(next[length])) {
+            length++;
+        }
+        if (next + length < end || !fill()) {
+            break;
+        }
+    }
+    std::string_view w {next, length};
+    next += length;
+    return w;
+}
+
+Strg Feed::input(const Strg& prompt) {
+    if (prompts) {
+        Sink& out = Sink::in_use();
+        out.put(prompt);
+        out.flush();
+    }
+    return Strg {std::string {word()}};
+}
+
+void Feed::slurp(void) {
+    struct stat st;
+    if (next == end && fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        off_t at = lseek(fd, 0, SEEK_CUR);
+        void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (at >= 0 && p != MAP_FAILED) {
+            mapped = p;
+            mapped_size = st.st_size;
+            next = static_cast<const char*>(p) + std::min<off_t>(at, st.st_size);
+            end = static_cast<const char*>(p) + st.st_size;
+            at_eof = true;
+            return;
+        }
+    }
+    // Otherwise read it all in, doubling the chunk as needed.
+    std::size_t size = end - next;
+    std::vector<char> all(size + CHUNK);
+    std::copy(next, end, all.begin());
+    while (!at_eof) {
+        if (size == all.size()) {
+            all.resize(2 * all.size());
+        }
+        ssize_t n;
+        do {
+            n = read(fd, all.data() + size, all.size() - size);
+        } while (n < 0 && errno == EINTR);
+        if (n <= 0) {
+            at_eof = true;
+        } else {
+            size += n;
+        }
+    }
+    chunk.swap(all);
+    next = chunk.data();
+    end = next + size;
+}
+
+//
+// class Srce
+//
+// - a source file's text
+//
+
+Srce::Srce(const std::string& fn) {
+    int fd = open(fn.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    opened = true;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        //
+        // Map zeroed pages enough for the text and the two NULs after it,
+        // then the file over the start of them. The rest of the file's
+        // last page reads as zeros too. The mapping is private, so what
+        // the scanner writes into it never reaches the file.
+        //
+        std::size_t page = sysconf(_SC_PAGESIZE);
+        std::size_t span = (st.st_size + 2 + page - 1) / page * page;
+        void* p = mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p != MAP_FAILED
+            && mmap(p, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) != MAP_FAILED) {
+            mapped = p;
+            mapped_size = span;
+            chars = static_cast<char*>(p);
+            size = st.st_size;
+            close(fd);
+            return;
+        }
+        if (p != MAP_FAILED) {
+            munmap(p, span);
+        }
+    }
+    char buffer[1 << 16];
+    ssize_t n;
+    while ((n = read(fd, buffer, sizeof(buffer))) != 0) {
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) break;
+        read_in.append(buffer, n);
+    }
+    size = read_in.size();
+    read_in.append(2, '\0');
+    chars = read_in.data();
+    close(fd);
+}
+
+Srce::~Srce(void) {
+    if (mapped) {
+        munmap(mapped, mapped_size);
+    }
+}
@@ -9,6 +9,7 @@
 //
 //  * DwislpyError    - an exception for reporting DWISLPY errors
 //  * Locn         - a (filename, line number, column number) for an error
+//  * Locs         - the table of locations that a `Locn` refers into
 //  * dwislpy_message - builds an error string 
 //
 // Some are for converting string literals to their actual strings, and
@@ -16,6 +17,30 @@
 //
 //   * de_escape, re_escape
 //
+// And one is the representation of DWISLPY string values, namely
+//
+//   * Strg - an immutable, reference-counted string
+//
+// And two are where a program's printed output goes and where its
+// input comes from, namely
+//
+//   * Sink - a buffer for the standard output
+//   * Feed - a buffered reader of the standard input
+//
+// And one holds the source of a program for the lexer, namely
+//
+//   * Srce - the text of a source file, mapped into memory
+//
+
+#include <string>
+#include <iostream>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstdio>
+#include <string_view>
+#include <atomic>
+#include "dwislpy-stats.hh"
 
 //
 // class Locn
@@ -24,18 +49,62 @@
 // line and column within that source file.
 //
 // This is typically used to report errors in the DWISLPY source code.
+// Every AST node holds one, so a `Locn` is just a 32-bit index into a
+// table of locations (see `Locs` below), and its parts are only looked
+// up when an error message is built.
 //
 class Locn {
 public:
-    std::string source_name;
-    int line;
-    int column;
+    Locn(const std::string& fn, int li, int co);
+    Locn(const std::string& fn) : Locn {fn, -1, -1} { }
+    Locn(void) : id {0} { }
+    const std::string& source_name(void) const;
+    int line(void) const;
+    int column(void) const;
+private:
+    std::uint32_t id;
+};
+
+//
+// class Locs
+//
+// A table of the locations within DWISLPY source files, one per `Driver`.
+// Each location is a file (given by its index into the table's list of
+// file names), a line, and a column. Entry 0 is the empty `Locn`.
+//
+// A `Locn` is made within the table that is in use, which is the one
+// set by the innermost `Locs::Use` object. Without one, a table for the
+// whole thread is used.
+//
+class Locs {
+public:
+    Locs(void);
+    Locs(const Locs&) = delete;
+    Locs& operator=(const Locs&) = delete;
+    std::uint32_t add(const std::string& fn, int li, int co);
+    void clear(void); // Forget all but the empty `Locn`.
+    void truncate(std::size_t n); // Forget all but the first `n`.
+    //
+    class Entry {
+    public:
+        std::uint32_t file;
+        int line;
+        int column;
+    };
+    std::vector<std::string> files;
+    std::vector<Entry> entries;
     //
-    Locn(std::string fn, int li, int co)
-        : source_name {fn}, line {li}, column {co} { }
-    Locn(std::string fn) 
-        : source_name {fn}, line {-1}, column {-1} { }
-    Locn(void) : Locn {"",0,0} { }
+    class Use {
+    public:
+        Use(Locs& locs) : prev {current} { current = &locs; }
+        ~Use(void) { current = prev; }
+    private:
+        Locs* prev;
+    };
+    static Locs& in_use(void);
+private:
+    static thread_local Locs* current;
+    std::unordered_map<std::string,std::uint32_t> file_ids;
 };
     
 //
@@ -53,6 +122,10 @@ const std::string dwislpy_message(Locn lo, std::string ms);
 // Thrown when an error is discovered while processing a DWISLPY source
 // file.
 //
+// `failure(e,fn)` gives the one to report instead for an exception `e`
+// of any other kind, such as running out of memory, raised while
+// processing the file named `fn`.
+//
 class DwislpyError: public std::exception {
 private:
     Locn location;
@@ -63,6 +136,16 @@ public:
     virtual const char* what() const noexcept;
 };
 
+DwislpyError failure(const std::exception& e, const std::string& fn);
+
+//
+// stack_limit() - the lowest address the running thread's C++ stack
+// should grow down to, leaving STACK_MARGIN bytes below it for whatever
+// is called from there. It is 0 when the stack is not known.
+//
+constexpr std::size_t STACK_MARGIN = 256 * 1024;
+std::uintptr_t stack_limit(void);
+
 //
 // Utility functions for dealing with string literals.
 //
@@ -72,4 +155,229 @@ std::string de_escape(std::string s); // Replace \d sequences with actuals.
 struct none { };
 extern none None;
 
+//
+// class Strg
+//
+// Holds the text of a DWISLPY string value. Copies of a `Strg` share
+// its text, counting how many there are. A `Strg` is just a pointer, so
+// copying one never allocates. The empty string needs no text at all.
+//
+// Shared text is never changed. The one exception is `append`, which
+// extends the text in place when no other `Strg` has it. Its capacity
+// grows geometrically, so a string built up by `+=` in a loop costs
+// time linear in its final length.
+//
+// `repeat(s,n)` gives `n` copies of `s`, built in a single allocation.
+//
+// The counts are not atomic, so a value should not be shared between
+// two threads that are both running DWISLPY code. The exception is a
+// text that is `share`d, such as that of a literal of a program run by
+// many threads at once: its count is kept atomically, and it is never
+// extended in place.
+//
+class Strg {
+public:
+    Strg(void) : text {nullptr} { }
+    Strg(std::string s);
+    Strg(const Strg& s) : text {s.text} {
+        if (text) hold();
+        DWISLPY_STAT(copies, 1);
+    }
+    Strg(Strg&& s) noexcept : text {s.text} {
+        s.text = nullptr;
+    }
+    Strg& operator=(Strg s) noexcept {
+        std::swap(text, s.text);
+        return *this;
+    }
+    ~Strg(void) {
+        if (text && release()) delete text;
+    }
+    const std::string& str(void) const;
+    std::size_t size(void) const { return text ? text->chars.size() : 0; }
+    void append(const Strg& s);
+    void share(void) { if (text) text->shared = true; }
+    friend Strg operator+(const Strg& s1, const Strg& s2);
+private:
+    struct Text {
+        std::atomic<unsigned int> refs;
+        bool shared;
+        std::string chars;
+    };
+    Text* text;
+    void hold(void) {
+        if (text->shared) {
+            text->refs.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            text->refs.store(text->refs.load(std::memory_order_relaxed) + 1,
+                             std::memory_order_relaxed);
+        }
+    }
+    bool release(void) { // Gives whether that was the last copy.
+        if (text->shared) {
+            return text->refs.fetch_sub(1, std::memory_order_acq_rel) == 1;
+        }
+        unsigned int refs = text->refs.load(std::memory_order_relaxed) - 1;
+        text->refs.store(refs, std::memory_order_relaxed);
+        return refs == 0;
+    }
+};
+
+Strg repeat(const Strg& s, long long n);
+std::ostream& operator<<(std::ostream& os, const Strg& s);
+
+//
+// class Sink
+//
+// Where `print` (and the prompt of `input`) sends its output. This is
+// collected in a large buffer, with ints formatted straight into it,
+// and written out only when the buffer fills, before reading any input,
+// before reporting an error, and at exit. A program's output thus costs
+// one system call per buffer, rather than one per line, as `std::endl`
+// would.
+//
+// With `line_buffered` set (by `--line-buffered`), each line is written
+// as soon as it ends instead, for running programs interactively.
+//
+// `Sink::out` is the one for the standard output. A sink can instead
+// collect what is written into a string, as each program run by
+// `--batch` does. The sink that `print` uses is the one set by the
+// innermost `Sink::Use` object of the running thread, or else `out`.
+//
+class Sink {
+public:
+    Sink(std::FILE* fp) : file {fp} { }
+    Sink(std::string& s) : file {nullptr}, into {&s} { }
+    Sink(const Sink&) = delete;
+    Sink& operator=(const Sink&) = delete;
+    ~Sink(void) { flush(); }
+    void put(char c) {
+        if (used == SIZE) flush();
+        buffer[used++] = c;
+        DWISLPY_STAT(output, 1);
+    }
+    void put(const char* cs, std::size_t n);
+    void put(const std::string& s) { put(s.data(), s.size()); }
+    void put(const Strg& s) { put(s.str()); }
+    void put(long long n);
+    void end(void) {
+        put('\n');
+        if (line_buffered) flush();
+    }
+    void flush(void);
+    bool line_buffered = false;
+    static Sink out;
+    //
+    class Use {
+    public:
+        Use(Sink& sink) : prev {current} { current = &sink; }
+        ~Use(void) { current = prev; }
+    private:
+        Sink* prev;
+    };
+    static Sink& in_use(void) { return current ? *current : out; }
+private:
+    static thread_local Sink* current;
+    static constexpr std::size_t SIZE = 1 << 16;
+    std::FILE* file;
+    std::string* into = nullptr;
+    std::size_t used = 0;
+    char buffer[SIZE];
+};
+
+//
+// class Feed
+//
+// Where `input` gets its words from. As with `std::cin >> s`, a word is
+// the next run of non-whitespace characters, and is empty at the end of
+// the input. Rather than take a character at a time from a stream, this
+// reads the input a large chunk at a time and scans each chunk for the
+// words. Each is given as a view of the chunk, good until the next call
+// of `word`.
+//
+// With `slurp`, the whole of the input is read in (or mapped, if it's a
+// file) at once, so that no word ever needs a further read.
+//
+// Each `input` outputs its prompt first, and writes out the output so
+// far so that it can be seen. For batch runs, `prompts` can be turned
+// off (by `--no-prompt`) to skip both.
+//
+// `Feed::in` is the one for the standard input. A feed can instead be
+// made over a text already in memory, good for as long as the feed.
+//
+class Feed {
+public:
+    Feed(int fd) : fd {fd} { }
+    Feed(std::string_view text) : fd {-1}, next {text.data()}, end {text.data() + text.size()}, at_eof {true} { }
+    Feed(const Feed&) = delete;
+    Feed& operator=(const Feed&) = delete;
+    ~Feed(void);
+    std::string_view word(void);
+    Strg input(const Strg& prompt);
+    void slurp(void);
+    bool prompts = true;
+    static Feed in;
+    //
+    class Use {
+    public:
+        Use(Feed& feed) : prev {current} { current = &feed; }
+        ~Use(void) { current = prev; }
+    private:
+        Feed* prev;
+    };
+    static Feed& in_use(void) { return current ? *current : in; }
+private:
+    static thread_local Feed* current;
+    bool fill(void);
+    static constexpr std::size_t CHUNK = 1 << 16;
+    int fd;
+    std::vector<char> chunk;   // What has been read, unless mapped.
+    const char* next = nullptr; // The unscanned part of what was read.
+    const char* end = nullptr;
+    bool at_eof = false;
+    void* mapped = nullptr;    // The input file, when slurped by mapping.
+    std::size_t mapped_size = 0;
+};
+
+//
+// class Srce
+//
+// The text of a DWISLPY source file. A regular file is mapped into
+// memory rather than read, and anything else (e.g. a pipe) is read in
+// whole. The lexer scans the text where it is (see `Lexer::scan` in
+// dwislpy-flex.ll), so that the source is never copied into a buffer
+// of its own. Flex needs two NULs after the text for that, and writes
+// into it as it goes, so `scan_buffer` gives the text along with them
+// as writable. (The mapping is private, so the file never changes.)
+//
+// Whether the file could be opened is given by `good`. A `Srce` can
+// instead be made from a text `Given` in memory, which it copies.
+//
+class Srce {
+public:
+    struct Given {
+        std::string_view text;
+    };
+    Srce(const std::string& fn);
+    Srce(Given given) : opened {true}, read_in {given.text} {
+        size = read_in.size();
+        read_in.append(2, '\0');
+        chars = read_in.data();
+    }
+    Srce(const Srce&) = delete;
+    Srce& operator=(const Srce&) = delete;
+    ~Srce(void);
+    bool good(void) const { return opened; }
+    std::string_view text(void) const { return {chars, size}; }
+    char* scan_buffer(void) { return chars; }
+private:
+    bool opened = false;
+    char* chars = empty;
+    std::size_t size = 0;
+    void* mapped = nullptr;
+    std::size_t mapped_size = 0;
+    std::string read_in;       // The text, when it couldn't be mapped.
+    char empty[2] = {'\0', '\0'};
+};
+
 #endif
@@ -0,0 +1,901 @@
+#include <string>
+#include <variant>
+#include <vector>
+#include <optional>
+#include <unordered_map>
+#include <iostream>
+#include <iomanip>
+#include <exception>
+#include <algorithm>
+
+#include "dwislpy-vm.hh"
+#include "dwislpy-ast.hh"
+#include "dwislpy-util.hh"
+
+//
+// dwislpy-vm.cc
+//
+// Below are the implementations of the DWISLPY bytecode engine. They are
+// organized into three groups. The first gives the methods of `Bytc` used
+// to build a program's code. The second is the compiler, given by the
+//
+//    Prgm::emit, Defn::emit, Blck::emit, Stmt::emit, Expn::push
+//
+// methods of the AST nodes. The third is `Mach::run`, the machine that
+// executes that code. It is meant to behave exactly as Prgm::run does.
+//
+
+// * * * * *
+//
+// Bytc
+//
+// - building and listing a compiled program.
+//
+
+//
+// effect(op,arg)
+//
+// How many values an instruction leaves on the stack, less how many it
+// takes off. Used by `emit` to bound the temporaries of a body. (The
+// bound is not tight where control flow joins, e.g. after an `Inif`,
+// but it never falls short.)
+//
+static int effect(const Bytc& bc, Opcd op, int arg) {
+    switch (op) {
+    case LTRL: case LOAD:
+        return 1;
+    case CALL:
+        return 1 - static_cast<int>(bc.funcs[arg].arity);
+    case TAIL:
+        return -static_cast<int>(bc.funcs[arg].arity);
+    case STOR: case PLEQ: case MNEQ: case POPV:
+    case PLUS: case MNUS: case TMES: case IDIV: case IMOD:
+    case CMLT: case CMGT: case CMEQ: case CMLE: case CMGE:
+    case JMPF: case RTRN: case PVAL:
+        return -1;
+    default:
+        return 0;
+    }
+}
+
+std::size_t Bytc::emit(Opcd op, int arg) {
+    depth += effect(*this, op, arg);
+    most = std::max(most, depth);
+    code.push_back(Inst {op, arg});
+    return code.size() - 1;
+}
+
+void Bytc::start(void) {
+    depth = 0;
+    most = 0;
+}
+
+unsigned int Bytc::finish(void) {
+    return static_cast<unsigned int>(most);
+}
+
+std::size_t Bytc::here(void) const {
+    return code.size();
+}
+
+void Bytc::patch(std::size_t at, std::size_t target) {
+    code[at].arg = static_cast<int>(target);
+}
+
+int Bytc::ltrl(Valu vl) {
+    if (Strg* s = std::get_if<Strg>(&vl)) s->share(); // (See Strg.)
+    ltrls.push_back(vl);
+    return static_cast<int>(ltrls.size() - 1);
+}
+
+int Bytc::locn(Locn lo) {
+    locns.push_back(lo);
+    return static_cast<int>(locns.size() - 1);
+}
+
+int Bytc::func(const Name& nm) const {
+    return func_ids.at(nm);
+}
+
+int Bytc::dclr(Func fn) {
+    int id = static_cast<int>(funcs.size());
+    func_ids[fn.name] = id;
+    funcs.push_back(fn);
+    return id;
+}
+
+static const char* opcd_name(Opcd op) {
+    static const char* names[] = {
+        "LTRL", "LOAD", "STOR", "PLEQ", "MNEQ", "POPV",
+        "PLUS", "MNUS", "TMES", "IDIV", "IMOD",
+        "CMLT", "CMGT", "CMEQ", "CMLE", "CMGE",
+        "IMUS", "NEGT", "JUMP", "JMPF", "CALL", "TAIL", "RTRN",
+        "PSPC", "PVAL", "PEND", "INPT", "INTC", "STRC", "HALT"
+    };
+    return names[op];
+}
+
+void Bytc::dump(std::ostream& os) const {
+    for (std::size_t i = 0; i < code.size(); i++) {
+        for (const Func& fn : funcs) {
+            if (fn.entry == i) {
+                os << fn.name << ":" << std::endl;
+            }
+        }
+        if (entry == i) {
+            os << "main:" << std::endl;
+        }
+        const Inst& in = code[i];
+        os << std::setw(6) << i << "    " << opcd_name(in.op);
+        switch (in.op) {
+        case LTRL:
+            os << " " << to_repr(ltrls[in.arg]);
+            break;
+        case LOAD: case STOR: case PLEQ: case MNEQ:
+        case JUMP: case JMPF:
+            os << " " << in.arg;
+            break;
+        case CALL: case TAIL:
+            os << " " << funcs[in.arg].name;
+            break;
+        default:
+            break;
+        }
+        os << std::endl;
+    }
+}
+
+// * * * * *
+//
+// Prgm::emit, Defn::emit, Blck::emit, Stmt::emit, Expn::push
+//
+// - compile DWISLPY code into bytecode. These rely on the slots that
+//   `chck` resolved for each variable, and so must be run after it.
+//
+
+void emit_defs(const Defs& defs, Bytc& bc) {
+    //
+    // Declare every definition first so that calls can be compiled
+    // before (or within) the body of the callee.
+    //
+    for (std::pair<Name,Defn_ptr> dfpr : defs) {
+        Defn_ptr df = dfpr.second;
+        bc.dclr(Func {df->name, df->arity(), df->args.get_size(), 0, 0, bc.locn(df->where())});
+    }
+    for (std::pair<Name,Defn_ptr> dfpr : defs) {
+        dfpr.second->emit(bc);
+    }
+}
+
+void Prgm::emit(Bytc& bc) const {
+    emit_defs(defs, bc);
+    bc.start();
+    bc.entry = bc.here();
+    bc.size = main_symt.get_size();
+    if (main) {
+        main->emit(bc);
+    }
+    bc.emit(HALT);
+    bc.temps = bc.finish();
+}
+
+void Defn::emit(Bytc& bc) const {
+    Func& fn = bc.funcs[bc.func(name)];
+    bc.start();
+    fn.entry = bc.here();
+    body->emit(bc);
+    // Falling off the end returns None, as in Defn::exec.
+    bc.emit(LTRL, bc.ltrl(Valu {None}));
+    bc.emit(RTRN);
+    fn.temps = bc.finish();
+}
+
+void Blck::emit(Bytc& bc) const {
+    for (Stmt_ptr s : stmts) {
+        s->emit(bc);
+    }
+}
+
+void Asgn::emit(Bytc& bc) const {
+    expn->push(bc);
+    bc.emit(STOR, slot);
+}
+
+void Ntro::emit(Bytc& bc) const {
+    expn->push(bc);
+    bc.emit(STOR, slot);
+}
+
+void Pleq::emit(Bytc& bc) const {
+    expn->push(bc);
+    bc.emit(PLEQ, slot);
+}
+
+void Mneq::emit(Bytc& bc) const {
+    expn->push(bc);
+    bc.emit(MNEQ, slot);
+}
+
+void Pass::emit([[maybe_unused]] Bytc& bc) const {
+    // does nothing!
+}
+
+void Prnt::emit(Bytc& bc) const {
+    for (std::size_t i = 0; i < expns.size(); i++) {
+        if (i > 0) {
+            bc.emit(PSPC);
+        }
+        expns[i]->push(bc);
+        bc.emit(PVAL);
+    }
+    bc.emit(PEND);
+}
+
+void Cond::emit(Bytc& bc) const {
+    std::vector<std::size_t> exits {};
+    for (Ifcd_ptr ifcd : ifcds) {
+        ifcd->cond->push(bc);
+        std::size_t skip = bc.emit(JMPF);
+        ifcd->body->emit(bc);
+        exits.push_back(bc.emit(JUMP));
+        bc.patch(skip, bc.here());
+    }
+    if (els) {
+        els->emit(bc);
+    }
+    for (std::size_t exit : exits) {
+        bc.patch(exit, bc.here());
+    }
+}
+
+void Ifcd::emit([[maybe_unused]] Bytc& bc) const {
+    throw DwislpyError(where(), "should not be called directly");
+}
+
+void Elif::emit([[maybe_unused]] Bytc& bc) const {
+    throw DwislpyError(where(), "should not be called directly");
+}
+
+void Else::emit(Bytc& bc) const {
+    body->emit(bc);
+}
+
+void Whil::emit(Bytc& bc) const {
+    std::size_t top = bc.here();
+    cond->push(bc);
+    std::size_t exit = bc.emit(JMPF);
+    body->emit(bc);
+    bc.emit(JUMP, top);
+    bc.patch(exit, bc.here());
+}
+
+void Rept::emit(Bytc& bc) const {
+    std::size_t top = bc.here();
+    body->emit(bc);
+    cond->push(bc);
+    bc.emit(JMPF, top);
+}
+
+void FRtn::emit(Bytc& bc) const {
+    FCll* call = dynamic_cast<FCll*>(expn);
+    if (call && bc.tails) {
+        for (Expn_ptr arg : call->args) {
+            arg->push(bc);
+        }
+        bc.emit(TAIL, bc.func(call->name));
+        return;
+    }
+    expn->push(bc);
+    bc.emit(RTRN);
+}
+
+void PRtn::emit(Bytc& bc) const {
+    bc.emit(LTRL, bc.ltrl(Valu {None}));
+    bc.emit(RTRN);
+}
+
+void PCll::emit(Bytc& bc) const {
+    for (Expn_ptr arg : args) {
+        arg->push(bc);
+    }
+    bc.emit(CALL, bc.func(name));
+    bc.emit(POPV);
+}
+
+void Expn::emit(Bytc& bc) const {
+    push(bc);
+    bc.emit(POPV);
+}
+
+void FCll::push(Bytc& bc) const {
+    for (Expn_ptr arg : args) {
+        arg->push(bc);
+    }
+    bc.emit(CALL, bc.func(name));
+}
+
+void Inif::push(Bytc& bc) const {
+    cond->push(bc);
+    std::size_t skip = bc.emit(JMPF);
+    if_br->push(bc);
+    std::size_t exit = bc.emit(JUMP);
+    bc.patch(skip, bc.here());
+    else_br->push(bc);
+    bc.patch(exit, bc.here());
+}
+
+void Conj::push(Bytc& bc) const {
+    lft->push(bc);
+    std::size_t skip = bc.emit(JMPF);
+    rht->push(bc);
+    std::size_t exit = bc.emit(JUMP);
+    bc.patch(skip, bc.here());
+    bc.emit(LTRL, bc.ltrl(Valu {false}));
+    bc.patch(exit, bc.here());
+}
+
+void Disj::push(Bytc& bc) const {
+    lft->push(bc);
+    std::size_t skip = bc.emit(JMPF);
+    bc.emit(LTRL, bc.ltrl(Valu {true}));
+    std::size_t exit = bc.emit(JUMP);
+    bc.patch(skip, bc.here());
+    rht->push(bc);
+    bc.patch(exit, bc.here());
+}
+
+void Negt::push(Bytc& bc) const {
+    expn->push(bc);
+    bc.emit(NEGT);
+}
+
+void Imus::push(Bytc& bc) const {
+    expn->push(bc);
+    bc.emit(IMUS);
+}
+
+void Cmlt::push(Bytc& bc) const {
+    lft->push(bc);
+    rht->push(bc);
+    bc.emit(CMLT);
+}
+
+void Cmgt::push(Bytc& bc) const {
+    lft->push(bc);
+    rht->push(bc);
+    bc.emit(CMGT);
+}
+
+void Cmeq::push(Bytc& bc) const {
+    lft->push(bc);
+    rht->push(bc);
+    bc.emit(CMEQ);
+}
+
+void Cmle::push(Bytc& bc) const {
+    lft->push(bc);
+    rht->push(bc);
+    bc.emit(CMLE);
+}
+
+void Cmge::push(Bytc& bc) const {
+    lft->push(bc);
+    rht->push(bc);
+    bc.emit(CMGE);
+}
+
+void Plus::push(Bytc& bc) const {
+    left->push(bc);
+    rght->push(bc);
+    bc.emit(PLUS, bc.locn(where()));
+}
+
+void Mnus::push(Bytc& bc) const {
+    left->push(bc);
+    rght->push(bc);
+    bc.emit(MNUS, bc.locn(where()));
+}
+
+void Tmes::push(Bytc& bc) const {
+    left->push(bc);
+    rght->push(bc);
+    bc.emit(TMES, bc.locn(where()));
+}
+
+void IDiv::push(Bytc& bc) const {
+    left->push(bc);
+    rght->push(bc);
+    bc.emit(IDIV, bc.locn(where()));
+}
+
+void IMod::push(Bytc& bc) const {
+    left->push(bc);
+    rght->push(bc);
+    bc.emit(IMOD, bc.locn(where()));
+}
+
+void Ltrl::push(Bytc& bc) const {
+    bc.emit(LTRL, bc.ltrl(valu));
+}
+
+void Lkup::push(Bytc& bc) const {
+    bc.emit(LOAD, slot);
+}
+
+void Inpt::push(Bytc& bc) const {
+    expn->push(bc);
+    bc.emit(INPT, bc.locn(where()));
+}
+
+void IntC::push(Bytc& bc) const {
+    expn->push(bc);
+    bc.emit(INTC, bc.locn(where()));
+}
+
+void StrC::push(Bytc& bc) const {
+    expn->push(bc);
+    bc.emit(STRC);
+}
+
+// * * * * *
+//
+// Mach::run
+//
+// - execute a compiled DWISLPY program. Each case of the dispatch loop
+//   below mirrors the `exec` or `eval` method of the AST node that
+//   emitted the instruction, including its run-time error messages.
+//
+
+//
+// move_to(dst,src), copy_to(dst,src)
+//
+// Store a value into a stack or frame slot. Most of the values moved
+// around are ints and bools, and assigning those directly is much cheaper
+// than the general variant assignment.
+//
+static inline void copy_to(Valu& dst, const Valu& src) {
+    if (const Word* n = std::get_if<Word>(&src)) {
+        dst = *n;
+    } else if (const bool* b = std::get_if<bool>(&src)) {
+        dst = *b;
+    } else {
+        dst = src;
+    }
+}
+
+static inline void move_to(Valu& dst, Valu& src) {
+    if (const Word* n = std::get_if<Word>(&src)) {
+        dst = *n;
+    } else if (const bool* b = std::get_if<bool>(&src)) {
+        dst = *b;
+    } else {
+        dst = std::move(src);
+    }
+}
+
+void Mach::run(void) {
+    stck.assign(bytc.size + bytc.temps, Valu {});
+    exec(bytc.entry, bytc.size, bytc.temps);
+}
+
+Valu Mach::call(const Func& fn, Valu* args) {
+    if (fn.size + fn.temps > stck.size()) {
+        stck.resize(fn.size + fn.temps);
+    }
+    for (unsigned int i = 0; i < fn.arity; i++) {
+        move_to(stck[i], args[i]);
+    }
+    return exec(fn.entry, fn.size, fn.temps).value();
+}
+
+std::optional<Valu> Mach::resume(const Func& seg, Valu* frame) {
+    if (seg.size + seg.temps > stck.size()) {
+        stck.resize(seg.size + seg.temps);
+    }
+    for (unsigned int i = 0; i < seg.size; i++) {
+        copy_to(stck[i], frame[i]);
+    }
+    std::optional<Valu> rv = exec(seg.entry, seg.size, seg.temps);
+    for (unsigned int i = 0; i < seg.size; i++) {
+        move_to(frame[i], stck[i]);
+    }
+    return rv;
+}
+
+//
+// Mach::exec(pc,size,temps)
+//
+// Runs the code at `pc` on a frame of `size` slots already set up at the
+// bottom of the stack, with room for `temps` more values above it. This
+// gives the value returned by that frame's RTRN, or nothing if it ends
+// at a HALT instead.
+//
+std::optional<Valu> Mach::exec(std::size_t pc, unsigned int size, unsigned int temps) {
+    const Inst* code = bytc.code.data();
+    frms.clear();
+    if (size + temps > stck.size()) {
+        stck.resize(size + temps);
+    }
+
+    //
+    // `bp` points to slot 0 of the current frame, and `sp` just past the
+    // top of the stack. Popped values are left in place to be overwritten.
+    //
+    Valu* bp = stck.data();
+    Valu* sp = bp + size;
+    Sink& out = Sink::in_use();
+
+    for (;;) {
+        const Inst in = code[pc++];
+        switch (in.op) {
+
+        case LTRL:
+            copy_to(*sp++, bytc.ltrls[in.arg]);
+            break;
+
+        case LOAD:
+            copy_to(*sp++, bp[in.arg]);
+            break;
+
+        case STOR:
+            move_to(bp[in.arg], *--sp);
+            break;
+
+        case PLEQ: {
+            Valu& rv = *--sp;
+            Valu& val = bp[in.arg];
+            if (holds_int(val)) {
+                Word* n = std::get_if<Word>(&val);
+                const Word* rn = std::get_if<Word>(&rv);
+                Word bumped = 0;
+                if (n && rn && add_fits(*n, *rn, bumped)) {
+                    *n = bumped;
+                } else {
+                    val = wide_add(val, rv);
+                }
+            } else if (std::holds_alternative<Strg>(val)) {
+                std::get<Strg>(val).append(std::get<Strg>(rv));
+            } else if (std::holds_alternative<bool>(val)) {
+                val = Valu(std::get<bool>(val) + std::get<bool>(rv));
+            }
+            break;
+        }
+
+        case MNEQ: {
+            Valu& rv = *--sp;
+            Valu& val = bp[in.arg];
+            if (holds_int(val)) {
+                Word* n = std::get_if<Word>(&val);
+                const Word* rn = std::get_if<Word>(&rv);
+                Word bumped = 0;
+                if (n && rn && sub_fits(*n, *rn, bumped)) {
+                    *n = bumped;
+                } else {
+                    val = wide_sub(val, rv);
+                }
+            } else if (std::holds_alternative<Strg>(val)) {
+                throw std::logic_error("Cannot subtract strings");
+            } else if (std::holds_alternative<bool>(val)) {
+                val = Valu(std::get<bool>(val) - std::get<bool>(rv));
+            }
+            break;
+        }
+
+        case POPV:
+            --sp;
+            break;
+
+        case PLUS: {
+            Valu& rv = *--sp;
+            Valu& lv = sp[-1];
+            Word n = 0;
+            if (std::holds_alternative<Word>(lv)
+                && std::holds_alternative<Word>(rv)
+                && add_fits(std::get<Word>(lv), std::get<Word>(rv), n)) {
+                lv = n;
+            } else if (std::holds_alternative<Strg>(lv)
+                       && std::holds_alternative<Strg>(rv)) {
+                // A chain of + builds on its own temporary in place.
+                std::get<Strg>(lv).append(std::get<Strg>(rv));
+            } else if (holds_int(lv) && holds_int(rv)) {
+                lv = wide_add(lv, rv);
+            } else {
+                std::string msg = "Run-time error: wrong operand type for plus.";
+                throw DwislpyError { bytc.locns[in.arg], msg };
+            }
+            break;
+        }
+
+        case MNUS: {
+            Valu& rv = *--sp;
+            Valu& lv = sp[-1];
+            Word n = 0;
+            if (std::holds_alternative<Word>(lv)
+                && std::holds_alternative<Word>(rv)
+                && sub_fits(std::get<Word>(lv), std::get<Word>(rv), n)) {
+                lv = n;
+            } else if (holds_int(lv) && holds_int(rv)) {
+                lv = wide_sub(lv, rv);
+            } else {
+                std::string msg = "Run-time error: wrong operand type for minus.";
+                throw DwislpyError { bytc.locns[in.arg], msg };
+            }
+            break;
+        }
+
+        case TMES: {
+            Valu& rv = *--sp;
+            Valu& lv = sp[-1];
+            Word n = 0;
+            if (std::holds_alternative<Word>(lv)
+                && std::holds_alternative<Word>(rv)
+                && mul_fits(std::get<Word>(lv), std::get<Word>(rv), n)) {
+                lv = n;
+            } else if (std::holds_alternative<Strg>(lv) && holds_int(rv)) {
+                lv = repeat(std::get<Strg>(lv), rv, bytc.locns[in.arg]);
+            } else if (holds_int(lv) && holds_int(rv)) {
+                lv = wide_mul(lv, rv);
+            } else {
+                std::string msg = "Run-time error: wrong operand type for times.";
+                throw DwislpyError { bytc.locns[in.arg], msg };
+            }
+            break;
+        }
+
+        case IDIV:
+        case IMOD: {
+            Valu& rv = *--sp;
+            Valu& lv = sp[-1];
+            if (std::holds_alternative<Word>(lv)
+                && std::holds_alternative<Word>(rv)) {
+                Word ln = std::get<Word>(lv);
+                Word rn = std::get<Word>(rv);
+                if (rn == 0) {
+                    throw DwislpyError { bytc.locns[in.arg], "Run-time error: division by 0."};
+                }
+                lv = in.op == IDIV ? floor_div(ln, rn) : floor_mod(ln, rn);
+            } else if (holds_int(lv) && holds_int(rv)) {
+                if (is_zero(rv)) {
+                    throw DwislpyError { bytc.locns[in.arg], "Run-time error: division by 0."};
+                }
+                lv = in.op == IDIV ? wide_div(lv, rv) : wide_mod(lv, rv);
+            } else {
+                std::string msg = "Run-time error: wrong operand type for ";
+                msg += in.op == IDIV ? "quotient." : "remainder.";
+                throw DwislpyError { bytc.locns[in.arg], msg };
+            }
+            break;
+        }
+
+        case CMLT: {
+            Valu& rv = *--sp;
+            Valu& lv = sp[-1];
+            if (std::holds_alternative<Word>(lv) && std::holds_alternative<Word>(rv)) {
+                lv = std::get<Word>(lv) < std::get<Word>(rv);
+            } else {
+                lv = wide_cmp(lv, rv) < 0;
+            }
+            break;
+        }
+
+        case CMGT: {
+            Valu& rv = *--sp;
+            Valu& lv = sp[-1];
+            if (std::holds_alternative<Word>(lv) && std::holds_alternative<Word>(rv)) {
+                lv = std::get<Word>(lv) > std::get<Word>(rv);
+            } else {
+                lv = wide_cmp(lv, rv) > 0;
+            }
+            break;
+        }
+
+        case CMEQ: {
+            Valu& rv = *--sp;
+            Valu& lv = sp[-1];
+            if (std::holds_alternative<Word>(lv) && std::holds_alternative<Word>(rv)) {
+                lv = std::get<Word>(lv) == std::get<Word>(rv);
+            } else {
+                lv = wide_cmp(lv, rv) == 0;
+            }
+            break;
+        }
+
+        case CMLE: {
+            Valu& rv = *--sp;
+            Valu& lv = sp[-1];
+            if (std::holds_alternative<Word>(lv) && std::holds_alternative<Word>(rv)) {
+                lv = std::get<Word>(lv) <= std::get<Word>(rv);
+            } else {
+                lv = wide_cmp(lv, rv) <= 0;
+            }
+            break;
+        }
+
+        case CMGE: {
+            Valu& rv = *--sp;
+            Valu& lv = sp[-1];
+            if (std::holds_alternative<Word>(lv) && std::holds_alternative<Word>(rv)) {
+                lv = std::get<Word>(lv) >= std::get<Word>(rv);
+            } else {
+                lv = wide_cmp(lv, rv) >= 0;
+            }
+            break;
+        }
+
+        case IMUS:
+            if (const Word* n = std::get_if<Word>(&sp[-1])) {
+                sp[-1] = -*n;
+            } else {
+                sp[-1] = wide_neg(sp[-1]);
+            }
+            break;
+
+        case NEGT:
+            sp[-1] = !std::get<bool>(sp[-1]);
+            break;
+
+        case JUMP:
+            pc = in.arg;
+            break;
+
+        case JMPF:
+            if (!std::get<bool>(*--sp)) {
+                pc = in.arg;
+            }
+            break;
+
+        case CALL: {
+            const Func& fn = bytc.funcs[in.arg];
+            if (frms.size() >= max_depth) {
+                std::string msg = "Run-time error: maximum call depth exceeded.";
+                throw DwislpyError { bytc.locns[fn.locn], msg };
+            }
+            std::size_t base = (sp - stck.data()) - fn.arity;
+            std::size_t need = base + fn.size + fn.temps;
+            frms.push_back(Frme {pc, static_cast<std::size_t>(bp - stck.data())});
+            if (need > stck.size()) {
+                stck.resize(std::max(need, 2 * stck.size()));
+            }
+            bp = stck.data() + base;
+            sp = bp + fn.size;
+            pc = fn.entry;
+            break;
+        }
+
+        case TAIL: {
+            // The arguments become the first slots of the current frame.
+            const Func& fn = bytc.funcs[in.arg];
+            Valu* args = sp - fn.arity;
+            for (unsigned int i = 0; i < fn.arity; i++) {
+                move_to(bp[i], args[i]);
+            }
+            std::size_t base = bp - stck.data();
+            std::size_t need = base + fn.size + fn.temps;
+            if (need > stck.size()) {
+                stck.resize(std::max(need, 2 * stck.size()));
+                bp = stck.data() + base;
+            }
+            sp = bp + fn.size;
+            pc = fn.entry;
+            break;
+        }
+
+        case RTRN: {
+            if (frms.empty()) {
+                // A return from the bottom frame ends the run.
+                return std::move(sp[-1]);
+            }
+            // The caller's frame gets the value where the arguments were.
+            move_to(*bp, sp[-1]);
+            sp = bp + 1;
+            pc = frms.back().rtrn;
+            bp = stck.data() + frms.back().base;
+            frms.pop_back();
+            break;
+        }
+
+        case PSPC:
+            out.put(' ');
+            break;
+
+        case PVAL:
+            to_sink(out, *--sp);
+            break;
+
+        case PEND:
+            out.end();
+            break;
+
+        case INPT: {
+            Valu& v = sp[-1];
+            if (std::holds_alternative<Strg>(v)) {
+                v = Valu {Feed::in_use().input(std::get<Strg>(v))};
+            } else {
+                std::string msg = "Run-time error: prompt is not a string.";
+                throw DwislpyError { bytc.locns[in.arg], msg };
+            }
+            break;
+        }
+
+        case INTC: {
+            Valu& v = sp[-1];
+            if (holds_int(v)) {
+                // Already an int.
+            } else if (std::holds_alternative<Strg>(v)) {
+                Valu i {};
+                if (!parse_int(std::get<Strg>(v).str(), i)) {
+                    std::string msg = "Run-time error: \""+std::get<Strg>(v).str()+"\"";
+                    msg += "cannot be converted to an int.";
+                    throw DwislpyError { bytc.locns[in.arg], msg };
+                }
+                v = std::move(i);
+            } else if (std::holds_alternative<bool>(v)) {
+                v = Valu {std::get<bool>(v) ? 1 : 0};
+            } else {
+                std::string msg = "Run-time error: cannot convert to an int.";
+                throw DwislpyError { bytc.locns[in.arg], msg };
+            }
+            break;
+        }
+
+        case STRC:
+            sp[-1] = Valu {to_string(sp[-1])};
+            break;
+
+        case HALT:
+            return std::nullopt;
+        }
+    }
+}
+
+// * * * * *
+//
+// Tier
+//
+// - hand hot definitions and loops over from the interpreter.
+//
+
+void Tier::compile(void) {
+    emit_defs(defs, bytc);
+    compiled = true;
+}
+
+Valu Tier::call(const Defn& defn, const Ctxt& ctxt, const Args_vec& args) {
+    if (!compiled) {
+        compile();
+    }
+    const Func& fn = bytc.funcs[bytc.func(defn.name)];
+    //
+    // Evaluate the arguments into a frame of the interpreter first, since
+    // doing so can make other calls that use the machine.
+    //
+    Stck& stck = ctxt.stck;
+    Ctxt new_ctxt { stck, stck.push(fn.arity) };
+    for (unsigned int i = 0; i < fn.arity; i++) {
+        new_ctxt[i] = args[i]->eval(defs, ctxt);
+    }
+    Valu rv = mach.call(fn, stck.slots.data() + new_ctxt.base);
+    stck.pop(new_ctxt.base);
+    return rv;
+}
+
+std::optional<Valu> Tier::loop(const Stmt& lp, Ctxt& ctxt) {
+    if (!compiled) {
+        compile();
+    }
+    auto found = segs.find(&lp);
+    if (found == segs.end()) {
+        // The interpreter's frame is the topmost one while the loop runs.
+        unsigned int size = static_cast<unsigned int>(ctxt.stck.top - ctxt.base);
+        Func seg {"loop", 0, size, 0, 0, 0};
+        bytc.start();
+        seg.entry = bytc.here();
+        bytc.tails = false;
+        lp.emit(bytc);
+        bytc.tails = true;
+        bytc.emit(HALT);
+        seg.temps = bytc.finish();
+        found = segs.emplace(&lp, seg).first;
+    }
+    return mach.resume(found->second, ctxt.stck.slots.data() + ctxt.base);
+}
@@ -0,0 +1,245 @@
+#ifndef _DWISLPY_VM_H
+#define _DWISLPY_VM_H
+
+//
+// dwislpy-vm.hh
+//
+// Defines `Opcd`, `Inst`, `Bytc`, and `Mach` used by the DWISLPY bytecode
+// engine. This is an alternative to the tree-walking interpreter given by
+// Prgm::run, Stmt::exec, and Expn::eval. It is selected with `--vm`.
+//
+// A checked `Prgm` is lowered into a `Bytc` by the `emit` methods of the
+// AST nodes (see dwislpy-vm.cc), in the same way that `chck` is spread
+// over the nodes in dwislpy-check.cc. Statements emit code that leaves
+// the value stack unchanged. Expressions emit code (via `push`) that
+// leaves exactly one value on top of the stack.
+//
+// The resulting code is a single linear vector of instructions shared
+// by the main script and every definition. Each definition becomes a
+// `Func` that records its entry point and how many frame slots it needs.
+// The literals of the program are kept in a constant pool.
+//
+// A `Mach` then runs that code. It is a stack machine: a frame's slots
+// live at its base on the value stack and its temporaries above them.
+// A call leaves the (already evaluated) arguments where they are and
+// uses them as the first slots of the callee's frame, matching how
+// SymT hands out slots to formals first.
+//
+// While emitting, `Bytc` tracks (an upper bound on) how many temporaries
+// each body needs. The machine makes room for those once per call, so
+// that the instructions themselves never have to check for stack space.
+//
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <unordered_map>
+#include <cstdint>
+#include "dwislpy-ast.hh"
+#include "dwislpy-util.hh"
+
+// * * * * *
+//
+// Opcd - the DWISLPY bytecode operations.
+//
+// The argument of an instruction is noted to the right of each, where
+//   k - index into the constant pool `ltrls`
+//   s - frame slot
+//   t - code address to jump to
+//   f - index into `funcs`
+//   l - index into the location table `locns` (for run-time errors)
+//
+enum Opcd : std::uint8_t {
+    LTRL, // k   push ltrls[k]
+    LOAD, // s   push the value in slot s
+    STOR, // s   pop a value into slot s
+    PLEQ, // s   pop a value and add it into slot s
+    MNEQ, // s   pop a value and subtract it from slot s
+    POPV, //     discard the top of the stack
+    PLUS, // l   binary operations: pop right, pop left, push result
+    MNUS, // l
+    TMES, // l
+    IDIV, // l
+    IMOD, // l
+    CMLT, //
+    CMGT, //
+    CMEQ, //
+    CMLE, //
+    CMGE, //
+    IMUS, //     unary operations: pop operand, push result
+    NEGT, //
+    JUMP, // t   continue at t
+    JMPF, // t   pop a bool, continue at t when it is False
+    CALL, // f   call funcs[f] with its arguments on the stack
+    TAIL, // f   call funcs[f] in place of the current frame, whose
+          //     caller gets what it returns (for `return f(...)`)
+    RTRN, //     pop the return value, pop the frame, push the value
+    PSPC, //     print a separating space
+    PVAL, //     pop a value and print it
+    PEND, //     end a line of printed output
+    INPT, // l   pop a prompt, push a string of input
+    INTC, // l   int conversion
+    STRC, //     str conversion
+    HALT  //     stop the machine
+};
+
+//
+// class Inst - a single bytecode instruction.
+//
+class Inst {
+public:
+    Opcd op;
+    int arg;
+};
+
+//
+// class Func - what the machine needs to know to call a definition.
+//
+class Func {
+public:
+    Name name;
+    unsigned int arity;
+    unsigned int size;  // Number of frame slots, including the formals.
+    unsigned int temps; // Most temporaries its body needs at once.
+    std::size_t entry;  // Address of its first instruction.
+    int locn;           // Index of its location, for run-time errors.
+};
+
+//
+// class Bytc - a compiled DWISLPY program.
+//
+// The methods it provides for `emit` are:
+//   emit  - append an instruction, giving its address
+//   here  - the address of the next instruction to be emitted
+//   patch - set the (jump) argument of an emitted instruction
+//   ltrl  - add a value to the constant pool, giving its index
+//   locn  - add a location to the location table, giving its index
+//   func  - look up the index of a definition by its name
+//   dclr  - declare a definition, giving its index
+//   start, finish - bracket the code of a body, the latter giving the
+//           most temporaries that body needs
+//
+// A `return f(...)` makes a tail call with TAIL, unless `tails` is off.
+// It is turned off for the loop segments of `Tier`, which must give
+// back the frame that they were run on.
+//
+// The `dump` method outputs a listing of the code.
+//
+class Bytc {
+public:
+    std::vector<Inst> code;
+    std::vector<Valu> ltrls;
+    std::vector<Locn> locns;
+    std::vector<Func> funcs;
+    std::size_t entry = 0;  // Address where the main script starts.
+    unsigned int size = 0;  // Number of slots in the main script's frame.
+    unsigned int temps = 0; // Most temporaries the main script needs.
+    bool tails = true;
+    //
+    std::size_t emit(Opcd op, int arg = 0);
+    std::size_t here(void) const;
+    void patch(std::size_t at, std::size_t target);
+    int ltrl(Valu vl);
+    int locn(Locn lo);
+    int func(const Name& nm) const;
+    int dclr(Func fn);
+    void start(void);
+    unsigned int finish(void);
+    void dump(std::ostream& os) const;
+private:
+    std::unordered_map<Name,int> func_ids;
+    int depth = 0;
+    int most = 0;
+};
+
+//
+// class Mach - the machine that runs a `Bytc`.
+//
+//
+// Besides running a whole program, it can run a single definition, or
+// the rest of a loop, on behalf of the tree-walking interpreter (see
+// `Tier` below). Each of these runs to completion before giving back a
+// result, and so the machine is never entered twice at once.
+//
+//   call   - run a definition on the given arguments, giving its value
+//   resume - run a loop on a copy of the given frame, then copy it back,
+//            giving any value returned from within the loop
+//
+// A tail call reuses the frame of its caller, so a definition that
+// loops by calling itself (or others) last runs in constant space.
+// Making a call with `max_depth` calls already in progress is a
+// run-time error. Its frames are on the heap, so the default allows
+// far more than the interpreter's MAX_DEPTH.
+//
+constexpr unsigned int VM_MAX_DEPTH = 1000000;
+
+class Mach {
+public:
+    Mach(const Bytc& bc, unsigned int md = VM_MAX_DEPTH) : bytc {bc}, max_depth {md} { }
+    void run(void);
+    Valu call(const Func& fn, Valu* args);
+    std::optional<Valu> resume(const Func& seg, Valu* frame);
+private:
+    std::optional<Valu> exec(std::size_t pc, unsigned int size, unsigned int temps);
+    //
+    // Frme - the saved state of a caller, pushed by CALL, popped by RTRN.
+    //
+    class Frme {
+    public:
+        std::size_t rtrn;
+        std::size_t base;
+    };
+    const Bytc& bytc;
+    unsigned int max_depth;
+    std::vector<Valu> stck;
+    std::vector<Frme> frms;
+};
+
+//
+// emit_defs(defs,bc)
+//
+// Compiles every definition of a program into `bc`, as the first part
+// of Prgm::emit.
+//
+void emit_defs(const Defs& defs, Bytc& bc);
+
+//
+// class Tier - mixed-mode execution, selected by `--tiered`.
+//
+// The tree-walking interpreter starts running a program right away,
+// but is slow at running the same code over and over. When tiered, it
+// counts the calls of each `Defn` and the iterations of each `Whil` and
+// `Rept` loop (in their `heat`). Once one of these passes `HOT`, the
+// interpreter hands it over to the bytecode machine:
+//
+//   * later calls of a hot definition are made by `call`, which runs
+//     the definition (and so anything it calls) on the machine.
+//
+//   * a hot loop is finished by `loop`, which compiles just that loop
+//     into a segment of code ending in a HALT, and then resumes it on
+//     a copy of the interpreter's frame. The loop's variables keep the
+//     same slots, so the frame is copied back once the loop is done.
+//
+// The definitions are only compiled when something first gets hot, so
+// a program that never gets hot pays no more than counting.
+//
+class Tier {
+public:
+    static constexpr unsigned int HOT = 1000;
+    static bool hot(unsigned int& heat) {
+        return heat >= HOT || ++heat >= HOT;
+    }
+    Tier(const Defs& ds, unsigned int max_depth = VM_MAX_DEPTH) :
+        defs {ds}, bytc {}, mach {bytc, max_depth} { }
+    Valu call(const Defn& defn, const Ctxt& ctxt, const Args_vec& args);
+    std::optional<Valu> loop(const Stmt& lp, Ctxt& ctxt);
+private:
+    void compile(void);
+    const Defs& defs;
+    Bytc bytc;
+    Mach mach;
+    bool compiled = false;
+    std::unordered_map<const Stmt*,Func> segs; // The loops compiled so far.
+};
+
+#endif
@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+
+#include "dwislpy-rt.h"
+
+/*
+ * dwislpy-rt.c
+ *
+ * Implementation of the run-time support for generated C programs.
+ * See the header (.h) file for details.
+ */
+
+dw_str dw_empty = DW_LTRL("");
+
+static dw_str dw_none_str = DW_LTRL("None");
+static dw_str dw_true_str = DW_LTRL("True");
+static dw_str dw_false_str = DW_LTRL("False");
+
+void dw_error(const char* where, const char* msg) {
+    fflush(stdout);
+    fprintf(stderr, "%s %s\n", where, msg);
+    exit(1);
+}
+
+static void* dw_alloc(size_t size) {
+    void* p = malloc(size);
+    if (!p) {
+        fflush(stdout);
+        fprintf(stderr, "Run-time error: out of memory.\n");
+        exit(1);
+    }
+    return p;
+}
+
+void dw_free(dw_str* s) {
+    free(s->chars);
+    free(s);
+}
+
+/*
+ * dw_new(cap) - a fresh, empty, unshared string with room for `cap` chars
+ */
+static dw_str* dw_new(size_t cap) {
+    dw_str* s = dw_alloc(sizeof(dw_str));
+    s->refs = 1;
+    s->len = 0;
+    s->cap = cap;
+    s->chars = dw_alloc(cap + 1);
+    s->chars[0] = '\0';
+    return s;
+}
+
+static dw_str* dw_of_chars(const char* cs, size_t len) {
+    dw_str* s = dw_new(len);
+    memcpy(s->chars, cs, len);
+    s->chars[len] = '\0';
+    s->len = len;
+    return s;
+}
+
+/*
+ * dw_grow(s,cap) - make room in the unshared string `s` for `cap` chars,
+ * at least doubling its capacity so that repeated appends are cheap
+ */
+static void dw_grow(dw_str* s, size_t cap) {
+    if (cap <= s->cap) return;
+    if (cap < 2 * s->cap) cap = 2 * s->cap;
+    char* cs = realloc(s->chars, cap + 1);
+    if (!cs) {
+        fflush(stdout);
+        fprintf(stderr, "Run-time error: out of memory.\n");
+        exit(1);
+    }
+    s->chars = cs;
+    s->cap = cap;
+}
+
+dw_str* dw_cat(dw_str* s1, dw_str* s2) {
+    if (s2->len == 0) {
+        dw_drop(s2);
+        return s1;
+    }
+    if (s1->len == 0) {
+        dw_drop(s1);
+        return s2;
+    }
+    dw_str* s;
+    if (s1->refs == 1) {
+        /* Nobody else has `s1`, so build onto it. */
+        s = s1;
+        dw_grow(s, s1->len + s2->len);
+    } else {
+        s = dw_new(s1->len + s2->len);
+        memcpy(s->chars, s1->chars, s1->len);
+        s->len = s1->len;
+        dw_drop(s1);
+    }
+    memcpy(s->chars + s->len, s2->chars, s2->len);
+    s->len += s2->len;
+    s->chars[s->len] = '\0';
+    dw_drop(s2);
+    return s;
+}
+
+void dw_append(dw_str** v, dw_str* s) {
+    *v = dw_cat(*v, s);
+}
+
+dw_str* dw_repeat(dw_str* s, dw_int n, const char* where) {
+    if (n <= 0 || s->len == 0) {
+        dw_drop(s);
+        return &dw_empty;
+    }
+    if (n == 1) {
+        return s;
+    }
+    if ((unsigned long long)n > (SIZE_MAX - sizeof(dw_str)) / s->len) {
+        dw_error(where, "Run-time error: repeat count too large.");
+    }
+    dw_str* r = dw_new(s->len * n);
+    for (dw_int i = 0; i < n; i++) {
+        memcpy(r->chars + r->len, s->chars, s->len);
+        r->len += s->len;
+    }
+    r->chars[r->len] = '\0';
+    dw_drop(s);
+    return r;
+}
+
+/*
+ * dw_input(prompt)
+ *
+ * Outputs the prompt, then reads the next whitespace-delimited word of
+ * input, just as the interpreter does. Gives "" at the end of input.
+ */
+dw_str* dw_input(dw_str* prompt) {
+    dw_print_str(prompt);
+    dw_drop(prompt);
+    fflush(stdout);
+    int c = getchar();
+    while (c != EOF && isspace(c)) {
+        c = getchar();
+    }
+    if (c == EOF) {
+        return &dw_empty;
+    }
+    dw_str* s = dw_new(16);
+    while (c != EOF && !isspace(c)) {
+        dw_grow(s, s->len + 1);
+        s->chars[s->len++] = (char)c;
+        c = getchar();
+    }
+    if (c != EOF) {
+        ungetc(c, stdin);
+    }
+    s->chars[s->len] = '\0';
+    return s;
+}
+
+dw_str* dw_str_of_int(dw_int n) {
+    char cs[24];
+    int len = snprintf(cs, sizeof(cs), "%lld", n);
+    return dw_of_chars(cs, (size_t)len);
+}
+
+dw_str* dw_str_of_bool(dw_int b) {
+    return b ? &dw_true_str : &dw_false_str;
+}
+
+dw_str* dw_str_of_none(void) {
+    return &dw_none_str;
+}
+
+/*
+ * dw_int_of_str(s,where)
+ *
+ * Converts the leading integer of `s` as the interpreter's `int` does.
+ */
+dw_int dw_int_of_str(dw_str* s, const char* where) {
+    char* end;
+    errno = 0;
+    long long n = strtoll(s->chars, &end, 10);
+    if (end == s->chars) {
+        size_t size = s->len + 64;
+        char* msg = dw_alloc(size);
+        snprintf(msg, size, "Run-time error: \"%s\"cannot be converted to an int.", s->chars);
+        dw_error(where, msg);
+    }
+    if (errno == ERANGE) {
+        dw_error(where, DW_TOO_BIG);
+    }
+    dw_drop(s);
+    return n;
+}
+
+void dw_print_int(dw_int n) {
+    printf("%lld", n);
+}
+
+void dw_print_bool(dw_int b) {
+    fputs(b ? "True" : "False", stdout);
+}
+
+void dw_print_none(void) {
+    fputs("None", stdout);
+}
+
+void dw_print_str(const dw_str* s) {
+    fwrite(s->chars, 1, s->len, stdout);
+}
+
+void dw_print_space(void) {
+    putchar(' ');
+}
+
+void dw_print_end(void) {
+    putchar('\n');
+}
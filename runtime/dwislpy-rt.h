@@ -0,0 +1,127 @@
+#ifndef _DWISLPY_RT_H
+#define _DWISLPY_RT_H
+
+/*
+ * dwislpy-rt.h
+ *
+ * The run-time support for C programs generated by `dwislpy --emit-c`.
+ * A generated program includes this header and is linked with
+ * dwislpy-rt.c, e.g.
+ *
+ *     ./dwislpy --emit-c -O2 prog.py > prog.c
+ *     cc -O2 -Iruntime prog.c runtime/dwislpy-rt.c -o prog
+ *
+ * The DWISLPY types are represented as
+ *
+ *    int, bool, None - a dw_int (None is always 0)
+ *    str             - a pointer to a dw_str
+ *
+ * Unlike the interpreter's, these ints are only those of a 64-bit word,
+ * the interpreter's `Word`. An operation whose result does not fit is a
+ * run-time error, rather than making a bigger int, so that a C program
+ * never gives a different answer from the interpreter, only none.
+ *
+ * A dw_str is immutable and reference-counted, just as the interpreter's
+ * Strg. The generated code follows one rule for them: every str-valued
+ * expression yields a reference that its user owns, and that user
+ * either stores it, hands it on, or drops it. The functions below that
+ * take a dw_str* argument without dropping it say so.
+ *
+ * Literal strings are static dw_str objects whose count is DW_STATIC,
+ * so they are never freed, and never changed in place.
+ *
+ * Run-time errors are reported like the interpreter's, on stderr, and
+ * then the program exits with status 1.
+ */
+
+#include <stddef.h>
+
+typedef long long dw_int;
+
+typedef struct dw_str {
+    long refs;
+    size_t len;
+    size_t cap;
+    char* chars;
+} dw_str;
+
+#define DW_STATIC (-1L)
+#define DW_LTRL(s) { DW_STATIC, sizeof(s) - 1, 0, (char*)(s) }
+
+extern dw_str dw_empty;
+
+void dw_error(const char* where, const char* msg);
+void dw_free(dw_str* s);
+
+static inline dw_str* dw_ref(dw_str* s) {
+    if (s->refs != DW_STATIC) s->refs++;
+    return s;
+}
+
+static inline void dw_drop(dw_str* s) {
+    if (s->refs != DW_STATIC && --s->refs == 0) dw_free(s);
+}
+
+static inline void dw_set(dw_str** v, dw_str* s) {
+    dw_str* old = *v;
+    *v = s;
+    dw_drop(old);
+}
+
+void dw_append(dw_str** v, dw_str* s);           /* v += s */
+dw_str* dw_cat(dw_str* s1, dw_str* s2);          /* s1 + s2 */
+dw_str* dw_repeat(dw_str* s, dw_int n, const char* where); /* s * n */
+dw_str* dw_input(dw_str* prompt);                /* input(prompt) */
+dw_str* dw_str_of_int(dw_int n);                 /* str(n) */
+dw_str* dw_str_of_bool(dw_int b);                /* str(b) */
+dw_str* dw_str_of_none(void);                    /* str(None) */
+dw_int dw_int_of_str(dw_str* s, const char* where); /* int(s) */
+
+#define DW_TOO_BIG "Run-time error: too big an int for C."
+
+/* These fail on a result that is not a dw_int. */
+static inline dw_int dw_add(dw_int n1, dw_int n2, const char* where) {
+    dw_int n;
+    if (__builtin_add_overflow(n1, n2, &n)) dw_error(where, DW_TOO_BIG);
+    return n;
+}
+
+static inline dw_int dw_sub(dw_int n1, dw_int n2, const char* where) {
+    dw_int n;
+    if (__builtin_sub_overflow(n1, n2, &n)) dw_error(where, DW_TOO_BIG);
+    return n;
+}
+
+static inline dw_int dw_mul(dw_int n1, dw_int n2, const char* where) {
+    dw_int n;
+    if (__builtin_mul_overflow(n1, n2, &n)) dw_error(where, DW_TOO_BIG);
+    return n;
+}
+
+static inline dw_int dw_neg(dw_int n, const char* where) {
+    return dw_sub(0, n, where);
+}
+
+/* These round the quotient down, as Python (and the interpreter) does. */
+static inline dw_int dw_idiv(dw_int n, dw_int d, const char* where) {
+    if (d == 0) dw_error(where, "Run-time error: division by 0.");
+    if (d == -1) return dw_neg(n, where);
+    return (n % d != 0 && (n < 0) != (d < 0)) ? n / d - 1 : n / d;
+}
+
+static inline dw_int dw_imod(dw_int n, dw_int d, const char* where) {
+    if (d == 0) dw_error(where, "Run-time error: division by 0.");
+    if (d == -1) return 0;
+    dw_int r = n % d;
+    return (r != 0 && (r < 0) != (d < 0)) ? r + d : r;
+}
+
+/* Printing: these do not drop their dw_str* argument. */
+void dw_print_int(dw_int n);
+void dw_print_bool(dw_int b);
+void dw_print_none(void);
+void dw_print_str(const dw_str* s);
+void dw_print_space(void);
+void dw_print_end(void);
+
+#endif
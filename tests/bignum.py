@@ -0,0 +1,28 @@
+# Ints are unbounded: an int that overflows a machine word becomes a
+# bignum, which prints, compares, and divides as Python's ints do.
+def factorial(n: int) -> int:
+    f: int = 1
+    while n > 1:
+        f = f * n
+        n -= 1
+    return f
+
+big: int = 9223372036854775807
+print(big + 1)
+print(-big - 2)
+square: int = big * big
+print(square)
+print(square // big, square % big)
+print(square - big * big == 0, square > big)
+
+# Floor division and modulo round towards minus infinity.
+print(-7 // 2, -7 % 2, 7 // -2, 7 % -2, -7 // -2, -7 % -2)
+print(-square // 7, -square % 7)
+print(square // -1000000007, square % -1000000007)
+least: int = -big - 1
+print(least // -1, least % -1, -least)
+
+print(factorial(30))
+print(factorial(30) // factorial(28))
+print(int("-123456789012345678901234567890") + 1)
+print(str(factorial(25)) + "!")
@@ -0,0 +1,10 @@
+# Each call here makes its next one from under 500 nested additions, so
+# the tree-walking interpreter runs out of C++ stack well before its
+# limit of 1000 calls, and has to report that the maximum call depth
+# is exceeded rather than crash. (The bytecode machine prints 999.)
+def down(n: int, z: int) -> int:
+    if n == 0:
+        return 0
+    return 1 + z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (z + (down(n - 1, z)))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))
+
+print(down(999, 0))
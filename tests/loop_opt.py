@@ -0,0 +1,39 @@
+# Loops that -O3 rewrites: the products of a counter and a step are
+# strength-reduced to sums, and what the loop never changes is hoisted
+# out of it. These give the same output at -O3 as at -O0.
+def sums(n: int, k: int) -> int:
+    i: int = 0
+    total: int = 0
+    while i < n:
+        i += 1
+        total += i * 7 + i * 7 // 2 + (k * k + 3) - k // 3
+    return total
+
+def down(n: int, k: int) -> int:
+    j: int = n
+    total: int = 0
+    while j > 0:
+        j -= 2
+        total = total + j * k - j * k % 5 + (n - k)
+    return total
+
+def wide(n: int) -> int:
+    i: int = 0
+    last: int = 0
+    while i < n:
+        i += 1
+        last = i * 4611686018427387904 + i * 4611686018427387904
+    return last
+
+print(sums(10, 5))
+print(sums(0, 5))
+print(sums(1000, -4))
+print(down(11, 3))
+print(down(10, -3))
+print(wide(5))
+count: int = 0
+total: int = 0
+while count <= 20:
+    count += 3
+    total += count * count + count * 10 * 2
+print(count, total)
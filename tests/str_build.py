@@ -0,0 +1,25 @@
+# Strings built up by += in a loop, by + chains, and by *. Building onto
+# a string that another variable also holds leaves that one as it was.
+def wrap(n: int) -> str:
+    s: str = ""
+    while n > 0:
+        s = "<" + s + str(n) + ">"
+        n -= 1
+    return s
+
+digits: str = ""
+i: int = 0
+while i < 10:
+    digits += str(i)
+    digits += ","
+    i += 1
+print(digits)
+kept: str = digits
+digits += "end"
+print(kept)
+print(digits)
+line: str = "-" * 20
+line += "|" * 3 + "=" * 0 + "!" * -2
+print(line)
+print(wrap(5))
+print("" * 3 + "ab" * 1 + "")